@@ -0,0 +1,14 @@
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+// Benchmark names are slash separated key=value pairs, so results are easy to pick apart from the --json output
+inline std::string describe(const std::string& what, std::initializer_list<std::pair<const char*, int>> parameters)
+{
+  auto name = what;
+  for (auto& [key, value] : parameters)
+    name += "/" + std::string(key) + "=" + std::to_string(value);
+  return name;
+}
@@ -0,0 +1,79 @@
+#include "BenchmarkNames.h"
+
+#include <PluginEditor.h>
+#include <catch2/catch.hpp>
+
+namespace
+{
+  // An editor painted into an image the way its window would be, drawing only inside the clip
+  struct EditorFixture
+  {
+    explicit EditorFixture(int scalePercent)
+    {
+      editor.reset(dynamic_cast<SulfuricAudioProcessorEditor*>(processor.createEditor()));
+      editor->setVisible(true);
+      editor->setSize(SulfuricAudioProcessorEditor::WIDTH * scalePercent / 100, SulfuricAudioProcessorEditor::HEIGHT * scalePercent / 100);
+      image = juce::Image(juce::Image::ARGB, editor->getWidth(), editor->getHeight(), true);
+
+      for (auto* child : editor->getChildren())
+      {
+        if (auto* slider = dynamic_cast<juce::Slider*>(child))
+        {
+          knob = slider;
+          break;
+        }
+      }
+
+      // The first paint fills the cached images
+      paint(editor->getLocalBounds());
+    }
+
+    juce::uint32 paint(juce::Rectangle<int> area)
+    {
+      juce::Graphics g(image);
+      g.reduceClipRegion(area);
+      editor->paintEntireComponent(g, false);
+      return image.getPixelAt(area.getX(), area.getY()).getARGB();
+    }
+
+    // Moves one knob end to end and returns what that dirtied, as the window would see it
+    juce::Rectangle<int> turnKnob()
+    {
+      knob->setValue(knob->getValue() == knob->getMinimum() ? knob->getMaximum() : knob->getMinimum(), juce::dontSendNotification);
+      return editor->getLocalArea(knob, knob->getLocalBounds());
+    }
+
+    SulfuricAudioProcessor processor;
+    std::unique_ptr<SulfuricAudioProcessorEditor> editor;
+    juce::Image image;
+    juce::Slider* knob = nullptr;
+  };
+}
+
+TEST_CASE("Editor repaint", "[editor][benchmark]")
+{
+  for (auto scale : { 100, 150 })
+  {
+    EditorFixture fixture(scale);
+    REQUIRE(fixture.knob != nullptr);
+
+    // Nothing changed, e.g. the window was uncovered, so every component comes from its cache
+    BENCHMARK(describe("editorRepaint", { { "scale", scale }, { "dirty", 0 } }))
+    {
+      return fixture.paint(fixture.editor->getLocalBounds());
+    };
+
+    // What a knob moving under automation costs, only its own area is redrawn
+    BENCHMARK(describe("editorRepaint", { { "scale", scale }, { "dirty", 1 } }))
+    {
+      return fixture.paint(fixture.turnKnob());
+    };
+
+    // The same, were the whole window redrawn for it
+    BENCHMARK(describe("editorRepaintWholeWindow", { { "scale", scale }, { "dirty", 1 } }))
+    {
+      fixture.turnKnob();
+      return fixture.paint(fixture.editor->getLocalBounds());
+    };
+  }
+}
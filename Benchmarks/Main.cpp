@@ -0,0 +1,112 @@
+#define CATCH_CONFIG_RUNNER
+#define CATCH_CONFIG_EXTERNAL_INTERFACES
+
+#include <Simd.h>
+#include <catch2/catch.hpp>
+#include <juce_events/juce_events.h>
+
+#include <iostream>
+
+namespace
+{
+  struct Measurement
+  {
+    double mean, standardDeviation;
+  };
+
+  std::map<std::string, Measurement> measurements;
+
+  // Collects the mean of every benchmark as it finishes, whichever reporter is in use
+  struct MeasurementListener : Catch::TestEventListenerBase
+  {
+    using TestEventListenerBase::TestEventListenerBase;
+
+    void benchmarkEnded(Catch::BenchmarkStats<> const& stats) override
+    {
+      measurements[stats.info.name] = { stats.mean.point.count(), stats.standardDeviation.point.count() };
+    }
+  };
+
+  bool writeJson(const std::string& path)
+  {
+    auto results = new juce::DynamicObject();
+    for (auto& [name, measurement] : measurements)
+    {
+      auto result = new juce::DynamicObject();
+      result->setProperty("meanNs", measurement.mean);
+      result->setProperty("standardDeviationNs", measurement.standardDeviation);
+      results->setProperty(juce::Identifier(name), juce::var(result));
+    }
+
+    auto root = new juce::DynamicObject();
+    root->setProperty("simdWidth", SimdFloat::WIDTH);
+    root->setProperty("results", juce::var(results));
+
+    return juce::File::getCurrentWorkingDirectory().getChildFile(path).replaceWithText(juce::JSON::toString(juce::var(root)));
+  }
+
+  // Returns how many benchmarks got slower than the baseline by more than tolerance percent
+  int compareWithBaseline(const std::string& path, double tolerance)
+  {
+    auto baseline = juce::JSON::parse(juce::File::getCurrentWorkingDirectory().getChildFile(path));
+    auto* baselineResults = baseline["results"].getDynamicObject();
+
+    if (baselineResults == nullptr)
+    {
+      std::cerr << "Couldn't read a baseline from " << path << "\n";
+      return 1;
+    }
+
+    auto regressions = 0;
+    for (auto& [name, measurement] : measurements)
+    {
+      auto previous = baselineResults->getProperty(juce::Identifier(name));
+      if (!previous.isObject())
+        continue;
+
+      auto ratio = measurement.mean / (double)previous["meanNs"];
+      auto isRegression = ratio > 1.0 + tolerance / 100.0;
+      regressions += isRegression ? 1 : 0;
+
+      std::cout << (isRegression ? "REGRESSION " : "           ")
+                << juce::String(ratio, 3) << "x  " << name << "\n";
+    }
+
+    return regressions;
+  }
+}
+
+CATCH_REGISTER_LISTENER(MeasurementListener)
+
+int main(int argc, char* argv[])
+{
+  // The processor benchmarks create AudioProcessorValueTreeStates, which want a message manager
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+  Catch::Session session;
+
+  std::string jsonPath, baselinePath;
+  double tolerance = 10.0;
+
+  using namespace Catch::clara;
+  session.cli(session.cli()
+    | Opt(jsonPath, "file")["--json"]("write the mean and standard deviation of every benchmark to a JSON file")
+    | Opt(baselinePath, "file")["--baseline"]("compare against a JSON file written by --json, fails if anything got slower")
+    | Opt(tolerance, "percent")["--tolerance"]("how much slower than the baseline a benchmark may get (default 10)"));
+
+  if (auto result = session.applyCommandLine(argc, argv); result != 0)
+    return result;
+
+  auto failures = session.run();
+
+  if (!jsonPath.empty() && !writeJson(jsonPath))
+  {
+    std::cerr << "Couldn't write " << jsonPath << "\n";
+    ++failures;
+  }
+
+  if (!baselinePath.empty())
+    failures += compareWithBaseline(baselinePath, tolerance);
+
+  return failures;
+}
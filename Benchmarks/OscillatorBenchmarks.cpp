@@ -0,0 +1,123 @@
+#include <ReferenceOscillator.h>
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <string>
+#include <vector>
+
+namespace
+{
+  constexpr double sampleRate = 48000.0;
+  constexpr int blockSize = 512;
+  constexpr int numVoices = 16;
+
+  const char* qualityName(OscillatorQuality quality)
+  {
+    switch (quality)
+    {
+      case OscillatorQuality::exact: return "exact";
+      case OscillatorQuality::phasor: return "phasor";
+      case OscillatorQuality::cubic: return "cubic";
+      case OscillatorQuality::linear: return "linear";
+    }
+    return "";
+  }
+
+  double noteInHertz(int note)
+  {
+    return 440.0 * std::pow(2.0, (note - 69) / 12.0);
+  }
+
+  // The wavetable modes play the frequency their 32 bit phase increment can represent,
+  // compare against that so the measurement is interpolation noise rather than tuning
+  double playedFrequency(OscillatorQuality quality, double frequency)
+  {
+    if (quality == OscillatorQuality::cubic || quality == OscillatorQuality::linear)
+      return SulfuricWavetable::incrementForFrequency(frequency, sampleRate) / 4294967296.0 * sampleRate;
+
+    return frequency;
+  }
+
+  double signalToNoise(OscillatorQuality quality)
+  {
+    long double signal = 0, noise = 0;
+    std::vector<float> output(blockSize);
+
+    for (auto note = 21; note <= 108; note += 5)
+    {
+      ReferenceOscillator oscillator;
+      oscillator.setQuality(quality);
+      oscillator.setFrequency(noteInHertz(note), sampleRate);
+
+      auto frequency = (long double)playedFrequency(quality, noteInHertz(note));
+
+      for (auto n = 0; n < (int)sampleRate; n += blockSize)
+      {
+        oscillator.process(output.data(), blockSize);
+
+        for (auto i = 0; i < blockSize; ++i)
+        {
+          auto reference = std::sin(2.0L * std::numbers::pi_v<long double> * frequency * (n + i) / sampleRate);
+          signal += reference * reference;
+          noise += (output[(size_t)i] - reference) * (output[(size_t)i] - reference);
+        }
+      }
+    }
+
+    return (double)(10.0L * std::log10(signal / noise));
+  }
+}
+
+TEST_CASE("Oscillator signal to noise", "[oscillator]")
+{
+  // Everything has to beat 16 bit audio, the sine modes have to match float precision
+  auto quality = GENERATE(OscillatorQuality::exact, OscillatorQuality::phasor, OscillatorQuality::cubic, OscillatorQuality::linear);
+  auto snr = signalToNoise(quality);
+
+  WARN(qualityName(quality) << " SNR: " << snr << " dB");
+
+  if (quality == OscillatorQuality::linear)
+    CHECK(snr > 110.0);
+  else
+    CHECK(snr > 140.0);
+}
+
+TEST_CASE("Oscillator render", "[oscillator][benchmark]")
+{
+  std::vector<float> output(blockSize);
+
+  // What SulfuricVoice did before it had an oscillator: one double precision std::sin per sample
+  BENCHMARK("oscillator/std::sin/voices=16/block=512")
+  {
+    std::array<double, numVoices> angles {};
+    for (auto voice = 0; voice < numVoices; ++voice)
+    {
+      auto angleDelta = noteInHertz(48 + voice) / sampleRate * 2.0 * std::numbers::pi;
+      for (auto i = 0; i < blockSize; ++i)
+      {
+        output[(size_t)i] = (float)std::sin(angles[(size_t)voice]);
+        angles[(size_t)voice] += angleDelta;
+      }
+    }
+    return output[0];
+  };
+
+  for (auto quality : { OscillatorQuality::exact, OscillatorQuality::phasor, OscillatorQuality::cubic, OscillatorQuality::linear })
+  {
+    std::array<ReferenceOscillator, numVoices> oscillators;
+    for (auto voice = 0; voice < numVoices; ++voice)
+    {
+      oscillators[(size_t)voice].setQuality(quality);
+      oscillators[(size_t)voice].setFrequency(noteInHertz(48 + voice), sampleRate);
+    }
+
+    BENCHMARK("oscillator/" + std::string(qualityName(quality)) + "/voices=16/block=512")
+    {
+      for (auto& oscillator : oscillators)
+        oscillator.process(output.data(), blockSize);
+      return output[0];
+    };
+  }
+}
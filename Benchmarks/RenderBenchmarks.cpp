@@ -0,0 +1,433 @@
+#include "BenchmarkNames.h"
+
+#include <PluginSynthesiser.h>
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  constexpr double sampleRate = 48000.0;
+
+  // A processor holding a chord on each enabled bus, receiving a controller sweep at a fixed density every block
+  template <typename SampleType = float>
+  struct ProcessorFixture
+  {
+    ProcessorFixture(int numChannels, int blockSize, int numVoices, int samplesBetweenEvents, int numBuses = 1)
+    {
+      auto layout = processor.getBusesLayout();
+      for (auto bus = 0; bus < layout.outputBuses.size(); ++bus)
+        layout.outputBuses.getReference(bus) = bus >= numBuses ? juce::AudioChannelSet::disabled()
+                                             : numChannels == 1 ? juce::AudioChannelSet::mono()
+                                                                : juce::AudioChannelSet::stereo();
+      processor.setBusesLayout(layout);
+
+      processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+      processor.prepareToPlay(sampleRate, blockSize);
+      buffer.setSize(numChannels * numBuses, blockSize);
+
+      juce::MidiBuffer chord;
+      for (auto bus = 0; bus < numBuses; ++bus)
+        for (auto voice = 0; voice < numVoices; ++voice)
+          chord.addEvent(juce::MidiMessage::noteOn(bus + 1, 36 + voice * 3, 0.8f), 0);
+
+      buffer.clear();
+      processor.processBlock(buffer, chord);
+
+      if (samplesBetweenEvents > 0)
+        for (auto position = 0; position < blockSize; position += samplesBetweenEvents)
+          midi.addEvent(juce::MidiMessage::controllerEvent(1, 1, position % 128), position);
+    }
+
+    SampleType process()
+    {
+      buffer.clear();
+      processor.processBlock(buffer, midi);
+      return buffer.getSample(0, 0);
+    }
+
+    SulfuricAudioProcessor processor;
+    juce::AudioBuffer<SampleType> buffer;
+    juce::MidiBuffer midi;
+  };
+
+  // What processBlock did before SulfuricMidiRouter, kept for comparison
+  juce::MidiBuffer filterMidiMessagesForChannel(const juce::MidiBuffer& input, int channel)
+  {
+    juce::MidiBuffer output;
+
+    for (auto metadata : input)
+    {
+      auto message = metadata.getMessage();
+
+      if (message.getChannel() == channel)
+        output.addEvent(message, metadata.samplePosition);
+    }
+
+    return output;
+  }
+}
+
+TEST_CASE("Voice bank render sweep", "[voicebank][benchmark]")
+{
+  for (auto numVoices : { 1, 2, 4, 8, 16, 32, 64 })
+  {
+    SulfuricVoiceBank bank(numVoices);
+    bank.setSampleRate(sampleRate);
+
+    for (auto voice = 0; voice < numVoices; ++voice)
+      bank.startVoice(voice, 440.0 * std::pow(2.0, (24 + voice - 69) / 12.0), 0.5f);
+
+    for (auto blockSize : { 16, 64, 256, 1024, 4096 })
+    {
+      std::vector<float> output((size_t)blockSize);
+
+      BENCHMARK(describe("voiceBank", { { "voices", numVoices }, { "block", blockSize } }))
+      {
+        bank.render(output.data(), blockSize);
+        return output[0];
+      };
+    }
+  }
+}
+
+TEST_CASE("Voice bank filter cost", "[voicebank][filter][benchmark]")
+{
+  constexpr int blockSize = 512;
+  constexpr int numBlocks = 2000;
+  std::vector<float> output((size_t)blockSize);
+
+  // The envelope moves every voice's cutoff, so coefficients are recomputed every chunk
+  SulfuricFilter::Parameters filter;
+  filter.cutoffHz = 800.0f;
+  filter.resonance = 0.7f;
+  filter.envelopeOctaves = 3.0f;
+
+  for (auto numVoices : { 16, 64, 256 })
+  {
+    double secondsPerMode[2] = {};
+
+    for (auto mode : { SulfuricFilter::Mode::off, SulfuricFilter::Mode::lowPass })
+    {
+      SulfuricVoiceBank bank(numVoices);
+      bank.setSampleRate(sampleRate);
+      filter.mode = mode;
+      bank.setFilter(filter);
+
+      for (auto voice = 0; voice < numVoices; ++voice)
+        bank.startVoice(voice, 440.0 * std::pow(2.0, (24 + voice % 64 - 69) / 12.0), 0.5f);
+
+      BENCHMARK(describe("voiceBankFilter", { { "mode", (int)mode }, { "voices", numVoices }, { "block", blockSize } }))
+      {
+        bank.render(output.data(), blockSize);
+        return output[0];
+      };
+
+      auto start = juce::Time::getHighResolutionTicks();
+      for (auto block = 0; block < numBlocks; ++block)
+        bank.render(output.data(), blockSize);
+      secondsPerMode[mode == SulfuricFilter::Mode::off ? 0 : 1] = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+    }
+
+    // What the filter adds to one voice, whatever the oscillators cost
+    auto voiceSamples = (double)numVoices * blockSize * numBlocks;
+    std::cout << describe("filterPerVoice", { { "voices", numVoices } }) << ": " << (secondsPerMode[1] - secondsPerMode[0]) * 1.0e9 / voiceSamples
+              << " ns per voice per sample, " << secondsPerMode[1] * 1.0e9 / voiceSamples << " ns with the oscillator and envelope" << std::endl;
+  }
+}
+
+TEST_CASE("Unison against stacked voices", "[voicebank][unison][benchmark]")
+{
+  constexpr int blockSize = 512;
+  constexpr int copies = SulfuricVoiceBank::MAX_UNISON;
+  std::vector<float> left((size_t)blockSize), right((size_t)blockSize);
+
+  for (auto numNotes : { 1, 4, 16 })
+  {
+    // Every copy inside the note's own voice, under one envelope, mixed straight into both channels
+    SulfuricVoiceBank unison(numNotes);
+    unison.setSampleRate(sampleRate);
+    unison.setUnison({ copies, 25.0f, 1.0f });
+
+    // The same copies as voices of their own, each with its envelope
+    SulfuricVoiceBank stacked(numNotes * copies);
+    stacked.setSampleRate(sampleRate);
+
+    for (auto note = 0; note < numNotes; ++note)
+    {
+      auto frequency = 110.0 * std::pow(2.0, note / 12.0);
+      unison.startVoice(note, frequency, 0.5f);
+
+      for (auto copy = 0; copy < copies; ++copy)
+        stacked.startVoice(note * copies + copy, frequency * std::exp2(25.0 * (2.0 * copy / (copies - 1) - 1.0) / 1200.0), 0.5f);
+    }
+
+    BENCHMARK(describe("unison", { { "copies", copies }, { "notes", numNotes }, { "channels", 1 }, { "block", blockSize } }))
+    {
+      unison.render(left.data(), blockSize);
+      return left[0];
+    };
+
+    BENCHMARK(describe("unison", { { "copies", copies }, { "notes", numNotes }, { "channels", 2 }, { "block", blockSize } }))
+    {
+      unison.render(left.data(), right.data(), blockSize);
+      return left[0];
+    };
+
+    // Voices can't pan, so only in mono
+    BENCHMARK(describe("stackedVoices", { { "copies", copies }, { "notes", numNotes }, { "channels", 1 }, { "block", blockSize } }))
+    {
+      stacked.render(left.data(), blockSize);
+      return left[0];
+    };
+  }
+}
+
+TEST_CASE("processBlock sweep", "[processor][benchmark]")
+{
+  for (auto numChannels : { 1, 2 })
+    for (auto numVoices : { 1, 4, 16 })
+      for (auto samplesBetweenEvents : { 0, 256, 16 })
+        for (auto blockSize : { 16, 64, 256, 1024, 4096 })
+        {
+          ProcessorFixture<> fixture(numChannels, blockSize, numVoices, samplesBetweenEvents);
+
+          BENCHMARK(describe("processBlock", { { "channels", numChannels }, { "voices", numVoices }, { "samplesPerEvent", samplesBetweenEvents }, { "block", blockSize } }))
+          {
+            return fixture.process();
+          };
+        }
+}
+
+TEST_CASE("processBlock precision", "[processor][benchmark]")
+{
+  for (auto numChannels : { 1, 2 })
+  {
+    ProcessorFixture<float> floatFixture(numChannels, 512, 16, 0);
+    ProcessorFixture<double> doubleFixture(numChannels, 512, 16, 0);
+
+    BENCHMARK(describe("processBlockFloat", { { "channels", numChannels }, { "voices", 16 }, { "block", 512 } }))
+    {
+      return floatFixture.process();
+    };
+
+    BENCHMARK(describe("processBlockDouble", { { "channels", numChannels }, { "voices", 16 }, { "block", 512 } }))
+    {
+      return doubleFixture.process();
+    };
+  }
+}
+
+TEST_CASE("Parameter automation", "[parameters][benchmark]")
+{
+  // Every block moves this many of the continuous parameters, master first
+  for (auto numAutomated : { 0, 1, 7 })
+    for (auto blockSize : { 64, 512 })
+    {
+      ProcessorFixture<> fixture(2, blockSize, 16, 0);
+      auto& processor = fixture.processor;
+      std::atomic<float>* automated[] = { processor.masterParam, processor.sustainParam, processor.fineParam, processor.velocityParam,
+                                          processor.attackParam, processor.decayParam, processor.releaseParam };
+      auto block = 0;
+
+      BENCHMARK(describe("automation", { { "parameters", numAutomated }, { "block", blockSize } }))
+      {
+        auto position = (float)(++block % 100) / 100.0f;
+        for (auto i = 0; i < numAutomated; ++i)
+          automated[i]->store(0.05f + position * 0.1f);
+
+        return fixture.process();
+      };
+    }
+
+  for (auto numMoving : { 0, 8, 64 })
+  {
+    std::vector<std::atomic<float>> values(64);
+    SulfuricParameterEngine engine;
+    for (auto& value : values)
+      engine.add(&value, SulfuricParameterEngine::Smoothing::linear, 0.02);
+    engine.prepare(sampleRate, 512);
+    auto block = 0;
+
+    BENCHMARK(describe("parameterEngine", { { "parameters", 64 }, { "moving", numMoving }, { "block", 512 } }))
+    {
+      ++block;
+      for (auto i = 0; i < numMoving; ++i)
+        values[(size_t)i].store((float)(block % 2));
+
+      engine.process(512);
+      return engine.getValue(0);
+    };
+  }
+}
+
+TEST_CASE("Multi-out processBlock", "[processor][benchmark]")
+{
+  for (auto numBuses : { 1, 4, 16 })
+    for (auto numVoices : { 8, 32 })
+    {
+      ProcessorFixture<> fixture(2, 512, numVoices, 0, numBuses);
+
+      BENCHMARK(describe("multiOut", { { "buses", numBuses }, { "voicesPerBus", numVoices }, { "block", 512 } }))
+      {
+        return fixture.process();
+      };
+    }
+}
+
+TEST_CASE("Dense MIDI against the control interval", "[engine][benchmark]")
+{
+  constexpr int blockSize = 512;
+
+  for (auto controlInterval : { 1, SulfuricVoiceEngine::DEFAULT_CONTROL_INTERVAL })
+    for (auto samplesBetweenEvents : { 0, 64, 16, 4, 1 })
+    {
+      SulfuricVoiceEngine engine(64);
+      engine.setCurrentPlaybackSampleRate(sampleRate);
+      engine.setControlInterval(controlInterval);
+
+      for (auto voice = 0; voice < 16; ++voice)
+        engine.noteOn(1, 36 + voice * 3, 0.8f);
+
+      // An arpeggiator's worth of pedal and note offs for notes that aren't playing, every one of which the engine acts on
+      juce::MidiBuffer midi;
+      if (samplesBetweenEvents > 0)
+        for (auto event = 0; event * samplesBetweenEvents < blockSize; ++event)
+          midi.addEvent(event % 2 == 0 ? juce::MidiMessage::controllerEvent(1, 64, 0) : juce::MidiMessage::noteOff(1, 100), event * samplesBetweenEvents);
+
+      juce::AudioBuffer<float> buffer(2, blockSize);
+
+      BENCHMARK(describe("denseMidi", { { "controlInterval", controlInterval }, { "samplesPerEvent", samplesBetweenEvents }, { "block", blockSize } }))
+      {
+        buffer.clear();
+        engine.renderNextBlock(buffer, midi, 0, blockSize);
+        return buffer.getSample(0, 0);
+      };
+    }
+}
+
+TEST_CASE("Parallel voice rendering across cores", "[engine][benchmark]")
+{
+  constexpr int blockSize = 512;
+
+  // 1, 2, 4... and every core
+  std::vector<int> threadCounts;
+  auto numCores = juce::jmax(1, (int)std::thread::hardware_concurrency());
+  for (auto numThreads = 1; numThreads < numCores; numThreads *= 2)
+    threadCounts.push_back(numThreads);
+  threadCounts.push_back(numCores);
+
+  for (auto numVoices : { 32, 64, 256 })
+  {
+    for (auto numThreads : threadCounts)
+    {
+      SulfuricWorkerPool pool(numThreads - 1);
+      SulfuricVoiceEngine engine(numVoices);
+      engine.setCurrentPlaybackSampleRate(sampleRate);
+      engine.setWorkerPool(&pool);
+      engine.setParallelThreshold(1);
+
+      for (auto voice = 0; voice < numVoices; ++voice)
+        engine.noteOn(1 + voice % 16, 24 + voice % 96, 0.8f);
+
+      juce::AudioBuffer<float> buffer(2, blockSize);
+      juce::MidiBuffer midi;
+
+      BENCHMARK(describe("parallelVoices", { { "voices", numVoices }, { "threads", numThreads }, { "block", blockSize } }))
+      {
+        buffer.clear();
+        engine.renderNextBlock(buffer, midi, 0, blockSize);
+        return buffer.getSample(0, 0);
+      };
+    }
+  }
+}
+
+TEST_CASE("Memory footprint across instances", "[memory][benchmark]")
+{
+  // Not timed, prints what many prepared instances hold between them. The shared tables only count once.
+  for (auto numInstances : { 1, 10, 100 })
+  {
+    std::vector<std::unique_ptr<SulfuricAudioProcessor>> instances;
+    SulfuricAudioProcessor::MemoryFootprint footprint;
+    size_t instanceBytes = 0;
+
+    for (auto instance = 0; instance < numInstances; ++instance)
+    {
+      instances.push_back(std::make_unique<SulfuricAudioProcessor>());
+      instances.back()->prepareToPlay(sampleRate, 512);
+      footprint = instances.back()->getMemoryFootprint();
+      instanceBytes += footprint.instanceBytes;
+    }
+
+    auto totalBytes = instanceBytes + footprint.sharedBytes;
+    std::cout << describe("memory", { { "instances", numInstances } }) << ": " << totalBytes << " bytes, " << totalBytes / (size_t)numInstances
+              << " per instance, " << footprint.sharedBytes << " in " << footprint.sharedTables << " shared tables" << std::endl;
+
+    CHECK(footprint.sharedTables > 0);
+  }
+}
+
+TEST_CASE("MIDI routing", "[midi][benchmark]")
+{
+  constexpr int blockSize = 512;
+
+  for (auto numBuses : { 1, 4, 16 })
+    for (auto numEvents : { 8, 64, 512 })
+    {
+      // Spread over every channel
+      juce::MidiBuffer midi;
+      for (auto i = 0; i < numEvents; ++i)
+        midi.addEvent(juce::MidiMessage::noteOn(i % 16 + 1, 60, 0.8f), i * blockSize / numEvents);
+
+      SulfuricMidiRouter router;
+      router.prepare(numBuses, 2048);
+
+      BENCHMARK(describe("midiRouter", { { "buses", numBuses }, { "events", numEvents } }))
+      {
+        router.route(midi);
+
+        auto routed = 0;
+        for (auto bus = 0; bus < numBuses; ++bus)
+          for (const auto& metadata : router.getEventsForBus(bus))
+            routed += metadata.samplePosition;
+        return routed;
+      };
+
+      BENCHMARK(describe("midiFilterPerBus", { { "buses", numBuses }, { "events", numEvents } }))
+      {
+        auto routed = 0;
+        for (auto bus = 0; bus < numBuses; ++bus)
+          for (const auto metadata : filterMidiMessagesForChannel(midi, bus + 1))
+            routed += metadata.samplePosition;
+        return routed;
+      };
+    }
+}
+
+TEST_CASE("Note on and off against polyphony", "[engine][benchmark]")
+{
+  for (auto numVoices : { 16, 64, 256, 1024 })
+  {
+    SulfuricVoiceEngine engine(numVoices);
+    engine.setCurrentPlaybackSampleRate(sampleRate);
+
+    // Every voice busy, so each note on has to steal
+    for (auto voice = 0; voice < numVoices; ++voice)
+      engine.noteOn(voice % 16 + 1, voice / 16, 0.5f);
+
+    auto note = 0;
+
+    BENCHMARK(describe("noteOnOff", { { "voices", numVoices } }))
+    {
+      engine.noteOn(1, note, 0.5f);
+      engine.noteOff(1, note, true);
+      note = (note + 1) % 128;
+      return engine.getNumActiveVoices();
+    };
+  }
+}
@@ -0,0 +1,111 @@
+#include "BenchmarkNames.h"
+
+#include <PatchGenerator.h>
+#include <PluginEditor.h>
+#include <catch2/catch.hpp>
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+  constexpr double sampleRate = 48000.0;
+
+  juce::MemoryBlock makeState()
+  {
+    SulfuricAudioProcessor processor;
+    SulfuricPatchGenerator::apply(0x5eed, processor);
+
+    juce::MemoryBlock state;
+    processor.getStateInformation(state);
+    return state;
+  }
+
+  // Shown as well as created, since the editor only builds its components the first time it becomes visible
+  std::unique_ptr<juce::AudioProcessorEditor> openEditor(SulfuricAudioProcessor& processor)
+  {
+    std::unique_ptr<juce::AudioProcessorEditor> editor(processor.createEditor());
+    editor->setVisible(true);
+    return editor;
+  }
+
+  double millisecondsSince(juce::int64 start)
+  {
+    return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1000.0;
+  }
+}
+
+TEST_CASE("Startup", "[startup][benchmark]")
+{
+  auto state = makeState();
+
+  BENCHMARK("startup/create")
+  {
+    SulfuricAudioProcessor processor;
+    return processor.getNumParameters();
+  };
+
+  SulfuricAudioProcessor processor;
+
+  BENCHMARK("startup/restoreState")
+  {
+    processor.setStateInformation(state.getData(), (int)state.getSize());
+    return processor.getNumParameters();
+  };
+
+  BENCHMARK("startup/prepareToPlay")
+  {
+    SulfuricAudioProcessor prepared;
+    prepared.prepareToPlay(sampleRate, 512);
+    return prepared.getNumActiveVoices();
+  };
+
+  BENCHMARK("startup/openEditor")
+  {
+    auto editor = openEditor(processor);
+    return editor->getNumChildComponents();
+  };
+}
+
+TEST_CASE("Session load across instances", "[startup][benchmark]")
+{
+  // Not a Catch benchmark, each step only happens once per instance in a real session. Prints how long every step took in total.
+  constexpr int numInstances = 100;
+  auto state = makeState();
+
+  std::vector<std::unique_ptr<SulfuricAudioProcessor>> instances;
+  instances.reserve(numInstances);
+
+  auto start = juce::Time::getHighResolutionTicks();
+  for (auto instance = 0; instance < numInstances; ++instance)
+    instances.push_back(std::make_unique<SulfuricAudioProcessor>());
+  auto createMs = millisecondsSince(start);
+
+  start = juce::Time::getHighResolutionTicks();
+  for (auto& instance : instances)
+    instance->setStateInformation(state.getData(), (int)state.getSize());
+  auto restoreMs = millisecondsSince(start);
+
+  start = juce::Time::getHighResolutionTicks();
+  for (auto& instance : instances)
+    instance->prepareToPlay(sampleRate, 512);
+  auto prepareMs = millisecondsSince(start);
+
+  // The first editor in the process decodes the images, the rest find them cached
+  std::vector<std::unique_ptr<juce::AudioProcessorEditor>> editors;
+  start = juce::Time::getHighResolutionTicks();
+  editors.push_back(openEditor(*instances.front()));
+  auto firstEditorMs = millisecondsSince(start);
+
+  start = juce::Time::getHighResolutionTicks();
+  for (auto instance = 1; instance < numInstances; ++instance)
+    editors.push_back(openEditor(*instances[(size_t)instance]));
+  auto otherEditorsMs = millisecondsSince(start);
+
+  std::cout << describe("sessionLoad", { { "instances", numInstances } }) << ": create " << createMs << " ms, restore state " << restoreMs
+            << " ms, prepareToPlay " << prepareMs << " ms, first editor " << firstEditorMs << " ms, then "
+            << otherEditorsMs / (numInstances - 1) << " ms per editor" << std::endl;
+
+  CHECK(editors.size() == (size_t)numInstances);
+  editors.clear();
+}
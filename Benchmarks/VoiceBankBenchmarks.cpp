@@ -0,0 +1,36 @@
+#include <ReferenceOscillator.h>
+#include <VoiceBank.h>
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+// The voice bank itself is swept in RenderBenchmarks.cpp, this is the per-object render it replaced
+TEST_CASE("Oscillator objects render", "[voicebank][benchmark]")
+{
+  constexpr double sampleRate = 48000.0;
+  constexpr int blockSize = 512;
+
+  std::vector<float> output(blockSize), voiceOutput(blockSize);
+
+  for (auto numVoices : { 1, 2, 4, 8, 16, 32, 64 })
+  {
+    // One ReferenceOscillator per voice, like the old SulfuricVoice objects
+    std::vector<ReferenceOscillator> oscillators((size_t)numVoices);
+
+    for (auto voice = 0; voice < numVoices; ++voice)
+      oscillators[(size_t)voice].setFrequency(440.0 * std::pow(2.0, (24 + voice - 69) / 12.0), sampleRate);
+
+    BENCHMARK("oscillatorObjects/voices=" + std::to_string(numVoices) + "/block=" + std::to_string(blockSize))
+    {
+      for (auto& oscillator : oscillators)
+      {
+        oscillator.process(voiceOutput.data(), blockSize);
+        for (auto i = 0; i < blockSize; ++i)
+          output[(size_t)i] += voiceOutput[(size_t)i] * 0.5f;
+      }
+      return output[0];
+    };
+  }
+}
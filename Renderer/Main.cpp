@@ -0,0 +1,240 @@
+/*
+  ==============================================================================
+
+	Command line renderer: MIDI files in, WAV files out, no host needed.
+
+  ==============================================================================
+*/
+
+#include <OfflineRenderer.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+namespace
+{
+	void printUsage()
+	{
+		std::cout
+			<< "Usage:\n"
+			<< "  Renderer [options] <input.mid> <output.wav>\n"
+			<< "  Renderer [options] --jobs <jobs.txt>\n"
+			<< "  Renderer [options] --audition <count> [--first-seed <hex>] [--rank <feature>] [--top <n>]\n\n"
+			<< "Options:\n"
+			<< "  --state <file>        Plugin state written by getStateInformation (single job only)\n"
+			<< "  --sample-rate <hz>    Default 48000\n"
+			<< "  --block-size <n>      Default 512\n"
+			<< "  --tail <seconds>      Rendered after the last MIDI event, default is the patch's release\n"
+			<< "  --threads <n>         Batch worker threads, default is every core\n\n"
+			<< "jobs.txt holds one job per line: <input.mid> <output.wav> [state]\n"
+			<< "Relative paths are relative to jobs.txt, lines starting with # are ignored.\n\n"
+			<< "--audition previews <count> seeds from --first-seed on (default 1) and prints the --top (default 20)\n"
+			<< "as CSV, highest first by --rank: rms (default), peak, brightness or attack. --lowest reverses it.\n";
+	}
+
+	int auditionSeeds(const juce::ArgumentList& args, const SulfuricOfflineRenderer::Settings& settings)
+	{
+		auto numSeeds = args.getValueForOption("--audition").getIntValue();
+		auto firstSeed = args.containsOption("--first-seed") ? (juce::uint64)args.getValueForOption("--first-seed").getHexValue64() : 1;
+		auto top = args.containsOption("--top") ? args.getValueForOption("--top").getIntValue() : 20;
+		auto rank = args.containsOption("--rank") ? args.getValueForOption("--rank") : juce::String("rms");
+		auto numThreads = args.containsOption("--threads") ? args.getValueForOption("--threads").getIntValue() : juce::SystemStats::getNumCpus();
+
+		using Audition = SulfuricOfflineRenderer::Audition;
+		std::function<float(const Audition&)> feature;
+
+		if (rank == "rms")
+			feature = [](const Audition& a) { return a.rms; };
+		else if (rank == "peak")
+			feature = [](const Audition& a) { return a.peak; };
+		else if (rank == "brightness")
+			feature = [](const Audition& a) { return a.brightness; };
+		else if (rank == "attack")
+			feature = [](const Audition& a) { return a.attackSeconds; };
+		else
+		{
+			std::cerr << "Unknown feature " << rank << "\n";
+			return 1;
+		}
+
+		if (numSeeds <= 0)
+		{
+			std::cerr << "Nothing to audition\n";
+			return 1;
+		}
+
+		auto start = juce::Time::getMillisecondCounterHiRes();
+		auto auditions = SulfuricOfflineRenderer::auditionSeeds(firstSeed, numSeeds, settings, numThreads);
+		auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+		// Ties keep seed order, so the same run always prints the same list
+		auto lowest = args.containsOption("--lowest");
+		std::stable_sort(auditions.begin(), auditions.end(), [&](const Audition& a, const Audition& b)
+		{
+			return lowest ? feature(a) < feature(b) : feature(a) > feature(b);
+		});
+
+		std::cout << "seed,rms,peak,brightness,attack\n";
+		for (auto i = 0; i < juce::jmin(top, (int)auditions.size()); ++i)
+		{
+			auto& audition = auditions[(size_t)i];
+			std::cout << juce::String::toHexString((juce::int64)audition.seed) << ","
+				<< audition.rms << "," << audition.peak << "," << audition.brightness << "," << audition.attackSeconds << "\n";
+		}
+
+		std::cerr << numSeeds << " seeds in " << juce::String(wallSeconds, 3) << " s on " << numThreads << " threads\n";
+		return 0;
+	}
+
+	std::vector<SulfuricOfflineRenderer::Job> readJobs(const juce::File& jobsFile)
+	{
+		std::vector<SulfuricOfflineRenderer::Job> jobs;
+		auto directory = jobsFile.getParentDirectory();
+
+		juce::StringArray lines;
+		jobsFile.readLines(lines);
+
+		for (auto& line : lines)
+		{
+			if (line.trim().isEmpty() || line.trimStart().startsWithChar('#'))
+				continue;
+
+			juce::StringArray tokens;
+			tokens.addTokens(line, " \t", "\"");
+			tokens.removeEmptyStrings();
+			tokens.trim();
+
+			if (tokens.size() < 2)
+			{
+				std::cerr << "Skipping malformed job: " << line << "\n";
+				continue;
+			}
+
+			SulfuricOfflineRenderer::Job job;
+			job.midiFile = directory.getChildFile(tokens[0].unquoted());
+			job.outputFile = directory.getChildFile(tokens[1].unquoted());
+			if (tokens.size() > 2)
+				job.stateFile = directory.getChildFile(tokens[2].unquoted());
+
+			jobs.push_back(job);
+		}
+
+		return jobs;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+	juce::ArgumentList args(argc, argv);
+
+	if (args.size() == 0 || args.containsOption("--help|-h"))
+	{
+		printUsage();
+		return 0;
+	}
+
+	SulfuricOfflineRenderer::Settings settings;
+	if (args.containsOption("--sample-rate"))
+		settings.sampleRate = args.getValueForOption("--sample-rate").getDoubleValue();
+	if (args.containsOption("--block-size"))
+		settings.blockSize = args.getValueForOption("--block-size").getIntValue();
+	if (args.containsOption("--tail"))
+		settings.tailSeconds = args.getValueForOption("--tail").getDoubleValue();
+
+	if (settings.sampleRate <= 0.0 || settings.blockSize <= 0 || settings.tailSeconds.value_or(0.0) < 0.0)
+	{
+		std::cerr << "Sample rate and block size must be positive, tail can't be negative\n";
+		return 1;
+	}
+
+	if (args.containsOption("--audition"))
+		return auditionSeeds(args, settings);
+
+	std::vector<SulfuricOfflineRenderer::Job> jobs;
+	auto numThreads = 1;
+
+	if (args.containsOption("--jobs"))
+	{
+		auto jobsFile = args.getFileForOption("--jobs");
+		if (!jobsFile.existsAsFile())
+		{
+			std::cerr << "No jobs file at " << jobsFile.getFullPathName() << "\n";
+			return 1;
+		}
+
+		jobs = readJobs(jobsFile);
+		numThreads = args.containsOption("--threads")
+			? args.getValueForOption("--threads").getIntValue()
+			: juce::SystemStats::getNumCpus();
+	}
+	else
+	{
+		// Whatever is left once the options are gone are the two paths
+		juce::StringArray paths;
+		for (auto i = 0; i < args.size(); ++i)
+		{
+			if (args[i].isOption())
+			{
+				if (!args[i].text.containsChar('='))
+					++i; // Skip its value too
+			}
+			else
+				paths.add(args[i].text);
+		}
+
+		if (paths.size() != 2)
+		{
+			printUsage();
+			return 1;
+		}
+
+		SulfuricOfflineRenderer::Job job;
+		job.midiFile = juce::File::getCurrentWorkingDirectory().getChildFile(paths[0]);
+		job.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(paths[1]);
+		if (args.containsOption("--state"))
+		{
+			job.stateFile = args.getFileForOption("--state");
+			if (!job.stateFile.existsAsFile())
+			{
+				std::cerr << "No state file at " << job.stateFile.getFullPathName() << "\n";
+				return 1;
+			}
+		}
+
+		jobs.push_back(job);
+	}
+
+	auto start = juce::Time::getMillisecondCounterHiRes();
+	auto results = SulfuricOfflineRenderer::renderJobs(jobs, settings, numThreads);
+	auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+	auto failures = 0;
+	double audioSeconds = 0.0;
+
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		auto& result = results[i];
+
+		if (!result.wasOk())
+		{
+			std::cerr << jobs[i].midiFile.getFileName() << ": " << result.error << "\n";
+			++failures;
+			continue;
+		}
+
+		audioSeconds += result.audioSeconds;
+		std::cout << jobs[i].outputFile.getFullPathName() << ": "
+			<< juce::String(result.audioSeconds, 2) << " s of audio in "
+			<< juce::String(result.renderSeconds, 3) << " s, "
+			<< juce::String(result.getRealtimeFactor(), 1) << "x realtime\n";
+	}
+
+	if (jobs.size() > 1)
+		std::cout << jobs.size() - (size_t)failures << " jobs, " << juce::String(audioSeconds, 2) << " s of audio in "
+			<< juce::String(wallSeconds, 3) << " s on " << numThreads << " threads, "
+			<< juce::String(wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0, 1) << "x realtime overall\n";
+
+	return failures == 0 ? 0 : 1;
+}
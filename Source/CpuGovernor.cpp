@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+	Trades sound quality for CPU when blocks keep coming close to their
+	deadline, and gives it back once there is room again.
+
+  ==============================================================================
+*/
+
+#include "CpuGovernor.h"
+
+//==============================================================================
+void SulfuricCpuGovernor::prepare(double newSampleRate) noexcept
+{
+	sampleRate = newSampleRate;
+	tier = Tier::full;
+	overloadedRun = recoveredRun = 0;
+	stepsDown = stepsUp = 0;
+}
+
+SulfuricCpuGovernor::Tier SulfuricCpuGovernor::update(int numSamples, double seconds) noexcept
+{
+	if (numSamples <= 0)
+		return tier;
+
+	auto load = seconds * sampleRate / numSamples;
+
+	overloadedRun = load > settings.overloadLoad ? overloadedRun + 1 : 0;
+	recoveredRun = load < settings.recoveredLoad ? recoveredRun + 1 : 0;
+
+	if (overloadedRun >= settings.overloadBlocks && tier != Tier::shedVoices)
+	{
+		tier = (Tier)((int)tier + 1);
+		++stepsDown;
+		overloadedRun = 0;
+	}
+	else if (recoveredRun >= settings.recoveredBlocks && tier != Tier::full)
+	{
+		tier = (Tier)((int)tier - 1);
+		++stepsUp;
+		recoveredRun = 0;
+	}
+
+	return tier;
+}
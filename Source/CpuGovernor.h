@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+	Trades sound quality for CPU when blocks keep coming close to their
+	deadline, and gives it back once there is room again.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+
+//==============================================================================
+/**
+	Each block's processing time is compared with how long the block's audio
+	lasts. After overloadBlocks blocks in a row above overloadLoad the governor
+	steps down one tier, after recoveredBlocks in a row below recoveredLoad it
+	steps back up one. Recovering takes both a lower load and many more blocks
+	than overloading, so it doesn't flap between two tiers.
+
+	What each tier gives up is up to the processor, the governor only decides.
+*/
+class SulfuricCpuGovernor
+{
+public:
+	/** Each tier keeps the savings of the ones before it. */
+	enum class Tier : uint8_t
+	{
+		full,				// Everything as the parameters say
+		cheapOscillators,	// Linear interpolation instead of cubic or exact
+		coarseControl,		// A longer control interval
+		shedVoices			// Half the polyphony, quietest held voices released early
+	};
+
+	struct Settings
+	{
+		double overloadLoad = 0.75;
+		double recoveredLoad = 0.4;
+		int overloadBlocks = 4;
+		int recoveredBlocks = 64;
+	};
+
+	void setSettings(const Settings& newSettings) noexcept { settings = newSettings; }
+
+	/** Back to full quality. */
+	void prepare(double sampleRate) noexcept;
+
+	/** Audio thread. Takes how long the last block of numSamples took and returns the tier for the next one. */
+	Tier update(int numSamples, double seconds) noexcept;
+
+	Tier getTier() const noexcept { return tier; }
+
+	/** Steps taken since prepare(). */
+	int getNumStepsDown() const noexcept { return stepsDown; }
+	int getNumStepsUp() const noexcept { return stepsUp; }
+
+private:
+	Settings settings;
+	double sampleRate = 44100.0;
+
+	Tier tier = Tier::full;
+	int overloadedRun = 0, recoveredRun = 0;
+	int stepsDown = 0, stepsUp = 0;
+};
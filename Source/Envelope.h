@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+	ADSR settings in seconds, and the sample-rate specific segments the voice
+	bank turns them into.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+//==============================================================================
+struct SulfuricEnvelope
+{
+	struct Parameters
+	{
+		float attackSeconds = 0.015f;
+		float decaySeconds = 0.1f;
+		float sustainLevel = 1.0f;
+		float releaseSeconds = 0.015f;
+
+		bool operator==(const Parameters&) const = default;
+	};
+
+	/**
+		Every segment is offset + scale * x, with x falling exponentially from 1 to FLOOR
+		over length samples. That makes the curve x * ratio^n, which can be generated a
+		block at a time instead of one dependent multiply per sample.
+	*/
+	struct Segment
+	{
+		float ratio = 0.0f;
+		int length = 0;
+	};
+
+	// A segment has run its course once x is 60 dB down
+	constexpr static double FLOOR = 0.001;
+
+	static Segment makeSegment(double seconds, double sampleRate) noexcept
+	{
+		auto length = (int)std::lround(seconds * sampleRate);
+		if (length <= 0)
+			return {};
+
+		return { (float)std::pow(FLOOR, 1.0 / length), length };
+	}
+
+	void prepare(const Parameters& newParameters, double sampleRate) noexcept
+	{
+		parameters = newParameters;
+		attack = makeSegment(parameters.attackSeconds, sampleRate);
+		decay = makeSegment(parameters.decaySeconds, sampleRate);
+		release = makeSegment(parameters.releaseSeconds, sampleRate);
+	}
+
+	Parameters parameters;
+	Segment attack, decay, release;
+};
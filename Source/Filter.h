@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+	The voice's resonant multimode filter: a trapezoidal, zero-delay-feedback
+	state variable filter run on SimdFloat::WIDTH voices at once.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+//==============================================================================
+struct SulfuricFilter
+{
+	// Order matches the "filter" parameter's choices
+	enum class Mode { off, lowPass, bandPass, highPass };
+
+	struct Parameters
+	{
+		Mode mode = Mode::off;
+		float cutoffHz = 20000.0f;
+
+		// 0 to 1, ringing harder towards 1 without ever self-oscillating
+		float resonance = 0.0f;
+
+		// How far a voice's envelope at full level moves its cutoff
+		float envelopeOctaves = 0.0f;
+
+		bool operator==(const Parameters&) const = default;
+	};
+
+	// Cutoffs are kept inside this range, the top below Nyquist where the prewarping goes to infinity
+	constexpr static float MIN_HZ = 20.0f;
+	constexpr static float MAX_FRACTION_OF_SAMPLE_RATE = 0.49f;
+
+	/**
+		Coefficients for every lane. Each lane has its own cutoff, the resonance and mode are the same
+		for all. The state variable form stays stable however fast these change, so they are simply
+		swapped at control rate.
+	*/
+	struct Coefficients
+	{
+		SimdFloat a1, a2, a3;
+
+		// The output is m0 * input + m1 * band pass + m2 * low pass
+		SimdFloat m0, m1, m2;
+	};
+
+	/** The prewarped integrator gain for one cutoff, tan(pi * cutoff / sampleRate). */
+	static float getGain(float cutoffHz, double sampleRate) noexcept
+	{
+		auto hz = std::clamp(cutoffHz, MIN_HZ, MAX_FRACTION_OF_SAMPLE_RATE * (float)sampleRate);
+		return (float)std::tan(std::numbers::pi * hz / sampleRate);
+	}
+
+	/** 1 / Q, from 2 with no resonance down to just above 0. */
+	static float getDamping(float resonance) noexcept
+	{
+		return 2.0f - 1.98f * std::clamp(resonance, 0.0f, 1.0f);
+	}
+
+	/** gains holds one getGain() per lane. */
+	static Coefficients makeCoefficients(const Parameters& parameters, const float* gains) noexcept
+	{
+		alignas(32) float a1[SimdFloat::WIDTH], a2[SimdFloat::WIDTH], a3[SimdFloat::WIDTH];
+		auto k = getDamping(parameters.resonance);
+
+		for (auto lane = 0; lane < SimdFloat::WIDTH; ++lane)
+		{
+			auto g = gains[lane];
+			a1[lane] = 1.0f / (1.0f + g * (g + k));
+			a2[lane] = g * a1[lane];
+			a3[lane] = g * a2[lane];
+		}
+
+		auto m0 = 0.0f, m1 = 0.0f, m2 = 0.0f;
+		switch (parameters.mode)
+		{
+		case Mode::off:
+			m0 = 1.0f;
+			break;
+		case Mode::lowPass:
+			m2 = 1.0f;
+			break;
+		case Mode::bandPass:
+			m1 = 1.0f;
+			break;
+		case Mode::highPass:
+			m0 = 1.0f;
+			m1 = -k;
+			m2 = -1.0f;
+			break;
+		}
+
+		return { SimdFloat::load(a1), SimdFloat::load(a2), SimdFloat::load(a3),
+			SimdFloat::broadcast(m0), SimdFloat::broadcast(m1), SimdFloat::broadcast(m2) };
+	}
+
+	/** Filters one sample of every lane. ic1 and ic2 hold the two integrators' states between calls. */
+	static SimdFloat process(SimdFloat input, const Coefficients& c, SimdFloat& ic1, SimdFloat& ic2) noexcept
+	{
+		auto v3 = input - ic2;
+		auto band = c.a1 * ic1 + c.a2 * v3;
+		auto low = ic2 + c.a2 * ic1 + c.a3 * v3;
+
+		ic1 = band + band - ic1;
+		ic2 = low + low - ic2;
+
+		return c.m0 * input + c.m1 * band + c.m2 * low;
+	}
+};
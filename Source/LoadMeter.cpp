@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+	Per-block DSP load measurements, handed from the audio thread to whoever
+	is watching without ever blocking it.
+
+  ==============================================================================
+*/
+
+#include "LoadMeter.h"
+
+//==============================================================================
+void SulfuricLoadMeter::prepare(double newSampleRate)
+{
+	// Only the writer's side, a reader may be folding right now
+	sampleRate.store(newSampleRate, std::memory_order_relaxed);
+	droppedBlocks.store(0, std::memory_order_relaxed);
+	governorChanges.store(0, std::memory_order_relaxed);
+	governorTier.store(0, std::memory_order_relaxed);
+	worstGovernorTier.store(0, std::memory_order_relaxed);
+	preparation.fetch_add(1, std::memory_order_release);
+}
+
+void SulfuricLoadMeter::push(const BlockTiming& timing) noexcept
+{
+	// The only writer, so plain loads and stores are enough
+	if (timing.governorTier != governorTier.load(std::memory_order_relaxed))
+	{
+		governorChanges.store(governorChanges.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		governorTier.store(timing.governorTier, std::memory_order_relaxed);
+	}
+
+	if (timing.governorTier > worstGovernorTier.load(std::memory_order_relaxed))
+		worstGovernorTier.store(timing.governorTier, std::memory_order_relaxed);
+
+	int start1, size1, start2, size2;
+	fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+	if (size1 + size2 == 0)
+	{
+		droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	auto index = (size_t)(size1 > 0 ? start1 : start2);
+	timings[index] = timing;
+	timingPreparations[index] = preparation.load(std::memory_order_relaxed);
+	fifo.finishedWrite(1);
+}
+
+SulfuricLoadMeter::Snapshot SulfuricLoadMeter::getSnapshot() const
+{
+	// Losing the race only means the figures are as of the other thread's fold
+	if (!folding.exchange(true, std::memory_order_acquire))
+	{
+		fold();
+		folding.store(false, std::memory_order_release);
+	}
+
+	return readPublished();
+}
+
+void SulfuricLoadMeter::fold() const
+{
+	auto currentPreparation = preparation.load(std::memory_order_acquire);
+	if (currentPreparation != foldedPreparation)
+	{
+		foldedPreparation = currentPreparation;
+		folded = {};
+	}
+
+	const auto currentSampleRate = sampleRate.load(std::memory_order_relaxed);
+
+	int start1, size1, start2, size2;
+	fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+	auto foldRange = [&](int start, int size)
+	{
+		for (auto i = start; i < start + size; ++i)
+		{
+			// Pushed before the latest prepare(), at another sample rate perhaps
+			if (timingPreparations[(size_t)i] != currentPreparation)
+				continue;
+
+			auto& timing = timings[(size_t)i];
+			auto audioSeconds = timing.numSamples / currentSampleRate;
+			auto load = audioSeconds > 0.0 ? timing.blockSeconds / audioSeconds : 0.0;
+
+			// Weighted by the audio the block held, so the averages cover the same time whatever the block size.
+			// The first block sets them outright rather than being pulled towards zero.
+			auto weight = folded.totalBlocks == 0 ? 1.0 : 1.0 - std::exp(-audioSeconds / AVERAGING_SECONDS);
+
+			folded.lastLoad = load;
+			folded.averageLoad += weight * (load - folded.averageLoad);
+			folded.recentPeakLoad = juce::jmax(load, folded.recentPeakLoad * (1.0 - weight));
+			folded.worstLoad = juce::jmax(folded.worstLoad, load);
+
+			folded.lastBlockSeconds = timing.blockSeconds;
+			folded.averageBlockSeconds += weight * (timing.blockSeconds - folded.averageBlockSeconds);
+			folded.worstBlockSeconds = juce::jmax(folded.worstBlockSeconds, timing.blockSeconds);
+			folded.averageRenderSeconds += weight * (timing.renderSeconds - folded.averageRenderSeconds);
+			folded.averageGainSeconds += weight * (timing.gainSeconds - folded.averageGainSeconds);
+
+			folded.activeVoices = timing.activeVoices;
+			folded.maxActiveVoices = juce::jmax(folded.maxActiveVoices, timing.activeVoices);
+
+			++folded.totalBlocks;
+		}
+	};
+
+	foldRange(start1, size1);
+	foldRange(start2, size2);
+	fifo.finishedRead(size1 + size2);
+
+	folded.governorTier = governorTier.load(std::memory_order_relaxed);
+	folded.worstGovernorTier = worstGovernorTier.load(std::memory_order_relaxed);
+	folded.governorChanges = governorChanges.load(std::memory_order_relaxed);
+	folded.droppedBlocks = droppedBlocks.load(std::memory_order_relaxed);
+
+	publish(folded);
+}
+
+void SulfuricLoadMeter::publish(const Snapshot& snapshot) const noexcept
+{
+	std::array<juce::uint64, SNAPSHOT_WORDS> words{};
+	std::memcpy(words.data(), &snapshot, sizeof(Snapshot));
+
+	// Odd while the words are being written, only ever by the thread that holds folding
+	auto count = sequence.load(std::memory_order_relaxed);
+	sequence.store(count + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (size_t i = 0; i < SNAPSHOT_WORDS; ++i)
+		published[i].store(words[i], std::memory_order_relaxed);
+
+	sequence.store(count + 2, std::memory_order_release);
+}
+
+SulfuricLoadMeter::Snapshot SulfuricLoadMeter::readPublished() const noexcept
+{
+	std::array<juce::uint64, SNAPSHOT_WORDS> words{};
+
+	for (;;)
+	{
+		auto before = sequence.load(std::memory_order_acquire);
+		if ((before & 1) != 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		for (size_t i = 0; i < SNAPSHOT_WORDS; ++i)
+			words[i] = published[i].load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (sequence.load(std::memory_order_relaxed) == before)
+			break;
+	}
+
+	Snapshot snapshot;
+	std::memcpy(&snapshot, words.data(), sizeof(Snapshot));
+	return snapshot;
+}
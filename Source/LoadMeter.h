@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+	Per-block DSP load measurements, handed from the audio thread to whoever
+	is watching without ever blocking it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+//==============================================================================
+class SulfuricLoadMeter
+{
+public:
+	/** What the audio thread records once per processBlock. */
+	struct BlockTiming
+	{
+		int numSamples = 0;
+		int activeVoices = 0;
+		double renderSeconds = 0.0;		// Synth render, MIDI handling included
+		double gainSeconds = 0.0;		// Master gain
+		double blockSeconds = 0.0;		// The whole of processBlock
+		int governorTier = 0;			// SulfuricCpuGovernor::Tier the block rendered at
+	};
+
+	/** Running figures since prepare(), the same for every thread that asks. */
+	struct Snapshot
+	{
+		// Time spent in processBlock as a fraction of the audio the block held: the latest block, an average over
+		// about AVERAGING_SECONDS of audio, a peak that falls back at the same rate, and the worst single block
+		double lastLoad = 0.0, averageLoad = 0.0, recentPeakLoad = 0.0, worstLoad = 0.0;
+
+		double lastBlockSeconds = 0.0, averageBlockSeconds = 0.0, worstBlockSeconds = 0.0;
+		double averageRenderSeconds = 0.0, averageGainSeconds = 0.0;
+
+		int activeVoices = 0, maxActiveVoices = 0;
+
+		// The CPU governor's tier for the latest block, the lowest quality it has dropped to, and every change up or down
+		int governorTier = 0, worstGovernorTier = 0;
+		juce::uint64 governorChanges = 0;
+
+		// Blocks folded into the figures above, and on top of those the blocks dropped because the FIFO was full
+		juce::uint64 totalBlocks = 0, droppedBlocks = 0;
+	};
+
+	constexpr static double AVERAGING_SECONDS = 1.0;
+
+	/**
+		Call before playback starts, not concurrently with push(). Readers may carry on meanwhile,
+		the figures start over the next time anyone takes a snapshot.
+	*/
+	void prepare(double sampleRate);
+
+	/** Audio thread only. Wait-free, drops the timing if nobody has taken a snapshot for a while. */
+	void push(const BlockTiming&) noexcept;
+
+	/**
+		Any thread, any number of them, without taking anything from the others. Folds what the audio thread
+		pushed into the figures first, unless another thread is already doing that, and never waits on a lock.
+	*/
+	Snapshot getSnapshot() const;
+
+private:
+	void fold() const;
+	void publish(const Snapshot&) const noexcept;
+	Snapshot readPublished() const noexcept;
+
+	const static int CAPACITY = 512;
+
+	std::atomic<double> sampleRate{ 44100.0 };
+
+	// Bumped by prepare(), which leaves the FIFO and the folded figures to the next fold
+	std::atomic<juce::uint32> preparation{ 0 };
+
+	// Writer side. The tier is tracked here rather than through the FIFO so dropped timings can't hide a change.
+	// Mutable since getSnapshot() is const to its callers but consumes the FIFO
+	mutable juce::AbstractFifo fifo{ CAPACITY };
+	std::array<BlockTiming, CAPACITY> timings;
+	std::array<juce::uint32, CAPACITY> timingPreparations;
+	std::atomic<juce::uint64> droppedBlocks{ 0 }, governorChanges{ 0 };
+	std::atomic<int> governorTier{ 0 }, worstGovernorTier{ 0 };
+
+	// Whoever sets this is the FIFO's one consumer and the only thread touching the folded figures
+	mutable std::atomic<bool> folding{ false };
+	mutable juce::uint32 foldedPreparation = 0;
+	mutable Snapshot folded;
+
+	// The folded figures as of the last fold, copied word by word under a sequence count so a reader never
+	// takes half of one fold and half of the next
+	static_assert(std::is_trivially_copyable_v<Snapshot>);
+	constexpr static size_t SNAPSHOT_WORDS = (sizeof(Snapshot) + sizeof(juce::uint64) - 1) / sizeof(juce::uint64);
+	mutable std::atomic<juce::uint32> sequence{ 0 };
+	mutable std::array<std::atomic<juce::uint64>, SNAPSHOT_WORDS> published{};
+};
@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+	Sorts one block of incoming MIDI into per-bus event queues.
+
+  ==============================================================================
+*/
+
+#include "MidiRouter.h"
+
+//==============================================================================
+void SulfuricMidiRouter::prepare(int numBuses, int maxEventsPerBlock)
+{
+	events.resize((size_t)maxEventsPerBlock);
+	heads.assign((size_t)numBuses, -1);
+	tails.assign((size_t)numBuses, -1);
+	numEvents = 0;
+}
+
+bool SulfuricMidiRouter::route(const juce::MidiBuffer& midi) noexcept
+{
+	std::fill(heads.begin(), heads.end(), -1);
+	numEvents = 0;
+
+	const auto numBuses = getNumBuses();
+
+	for (const auto metadata : midi)
+	{
+		auto bus = getBusForChannel(getChannel(metadata));
+		if (bus < 0 || bus >= numBuses)
+			continue;
+
+		if (numEvents == (int)events.size())
+			return false;
+
+		events[(size_t)numEvents] = { metadata, -1 };
+
+		if (heads[(size_t)bus] < 0)
+			heads[(size_t)bus] = numEvents;
+		else
+			events[(size_t)tails[(size_t)bus]].next = numEvents;
+
+		tails[(size_t)bus] = numEvents;
+		++numEvents;
+	}
+
+	return true;
+}
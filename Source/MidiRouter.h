@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+	Sorts one block of incoming MIDI into per-bus event queues.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+//==============================================================================
+/**
+	Routes MIDI channel n + 1 to output bus n in a single pass over the block,
+	without copying message data or allocating.
+
+	Every routed event lives in one flat array, preallocated by prepare(), and the
+	events of each bus are chained together in time order. The queues point into
+	the routed MidiBuffer, so they are only valid until that buffer changes.
+*/
+class SulfuricMidiRouter
+{
+public:
+	struct Event
+	{
+		juce::MidiMessageMetadata metadata;
+		int next;
+	};
+
+	/** Iterates the events of one bus, yielding juce::MidiMessageMetadata like a MidiBuffer. */
+	class BusEvents
+	{
+	public:
+		struct Iterator
+		{
+			const Event* events;
+			int index;
+
+			const juce::MidiMessageMetadata& operator*() const noexcept { return events[index].metadata; }
+			Iterator& operator++() noexcept { index = events[index].next; return *this; }
+			bool operator!=(const Iterator& other) const noexcept { return index != other.index; }
+		};
+
+		Iterator begin() const noexcept { return { events, first }; }
+		Iterator end() const noexcept { return { events, -1 }; }
+		bool isEmpty() const noexcept { return first < 0; }
+
+		const Event* events;
+		int first;
+	};
+
+	/** Must be called off the audio thread, before routing blocks for up to numBuses buses. */
+	void prepare(int numBuses, int maxEventsPerBlock);
+
+	int getNumBuses() const noexcept { return (int)heads.size(); }
+
+	/**
+		Replaces the queues with the contents of midi. Returns false if the block held
+		more events than prepare() made room for, the queues are unusable then.
+	*/
+	bool route(const juce::MidiBuffer& midi) noexcept;
+
+	BusEvents getEventsForBus(int bus) const noexcept { return { events.data(), heads[(size_t)bus] }; }
+
+	size_t getMemoryUsage() const noexcept { return sizeof(*this) + events.capacity() * sizeof(Event) + (heads.capacity() + tails.capacity()) * sizeof(int); }
+
+	static int getBusForChannel(int midiChannel) noexcept { return midiChannel - 1; }
+
+	/** Same as MidiMessage::getChannel() without constructing the message. 0 for sysex and friends. */
+	static int getChannel(const juce::MidiMessageMetadata& metadata) noexcept
+	{
+		auto status = metadata.data[0];
+		return (status & 0xf0) != 0xf0 ? (status & 0x0f) + 1 : 0;
+	}
+
+private:
+	std::vector<Event> events;
+	std::vector<int> heads, tails;
+	int numEvents = 0;
+};
@@ -0,0 +1,269 @@
+/*
+  ==============================================================================
+
+	Renders MIDI files through SulfuricAudioProcessor without a host.
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include "PatchGenerator.h"
+
+#include <atomic>
+#include <thread>
+
+//==============================================================================
+bool SulfuricOfflineRenderer::readMidiFile(const juce::File& file, juce::MidiMessageSequence& sequence, juce::String& error)
+{
+	juce::FileInputStream stream(file);
+	juce::MidiFile midiFile;
+
+	if (!stream.openedOk() || !midiFile.readFrom(stream))
+	{
+		error = "Couldn't read MIDI file " + file.getFullPathName();
+		return false;
+	}
+
+	midiFile.convertTimestampTicksToSeconds();
+
+	sequence.clear();
+	for (auto track = 0; track < midiFile.getNumTracks(); ++track)
+		sequence.addSequence(*midiFile.getTrack(track), 0.0);
+
+	sequence.updateMatchedPairs();
+	return true;
+}
+
+SulfuricOfflineRenderer::Result SulfuricOfflineRenderer::render(SulfuricAudioProcessor& processor, const juce::MidiMessageSequence& sequence, const Settings& settings, juce::AudioBuffer<float>& output)
+{
+	Result result;
+
+	const auto sampleRate = settings.sampleRate;
+	const auto blockSize = settings.blockSize;
+	const auto lastEventTime = sequence.getNumEvents() > 0 ? sequence.getEndTime() : 0.0;
+	const auto tailSeconds = settings.tailSeconds.value_or(processor.getTailLengthSeconds());
+	const auto totalSamples = (int)std::ceil((lastEventTime + tailSeconds) * sampleRate);
+
+	// Offline there is no deadline, so the CPU governor never trades quality away
+	processor.setNonRealtime(true);
+	processor.setUsesWorkerThreads(settings.useWorkerThreads);
+	processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+	processor.prepareToPlay(sampleRate, blockSize);
+
+	output.setSize(processor.getTotalNumOutputChannels(), totalSamples);
+	output.clear();
+
+	juce::AudioBuffer<float> block(output.getNumChannels(), blockSize);
+	juce::MidiBuffer midi;
+	midi.ensureSize(4096);
+
+	auto nextEvent = 0;
+	double renderSeconds = 0.0;
+
+	for (auto position = 0; position < totalSamples; position += blockSize)
+	{
+		const auto numSamples = juce::jmin(blockSize, totalSamples - position);
+
+		midi.clear();
+		for (; nextEvent < sequence.getNumEvents(); ++nextEvent)
+		{
+			const auto& message = sequence.getEventPointer(nextEvent)->message;
+			auto samplePosition = juce::roundToInt(message.getTimeStamp() * sampleRate);
+
+			if (samplePosition >= position + numSamples)
+				break;
+
+			midi.addEvent(message, juce::jmax(0, samplePosition - position));
+		}
+
+		// Hosts hand a synth a cleared buffer, so do we
+		block.setSize(block.getNumChannels(), numSamples, false, false, true);
+		block.clear();
+
+		auto start = juce::Time::getHighResolutionTicks();
+		processor.processBlock(block, midi);
+		renderSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+		for (auto channel = 0; channel < output.getNumChannels(); ++channel)
+			output.copyFrom(channel, position, block, channel, 0, numSamples);
+	}
+
+	processor.releaseResources();
+
+	result.audioSeconds = totalSamples / sampleRate;
+	result.renderSeconds = renderSeconds;
+	return result;
+}
+
+SulfuricOfflineRenderer::Result SulfuricOfflineRenderer::renderJob(SulfuricAudioProcessor& processor, const Job& job, const Settings& settings, const juce::MemoryBlock& defaultState)
+{
+	Result result;
+
+	juce::MidiMessageSequence sequence;
+	if (!readMidiFile(job.midiFile, sequence, result.error))
+		return result;
+
+	// Always restore a state, so a processor reused across jobs doesn't leak one job's patch into the next
+	juce::MemoryBlock state;
+	if (job.stateFile.existsAsFile())
+	{
+		if (!job.stateFile.loadFileAsData(state))
+		{
+			result.error = "Couldn't read state " + job.stateFile.getFullPathName();
+			return result;
+		}
+	}
+	else
+	{
+		state = defaultState;
+	}
+
+	processor.setStateInformation(state.getData(), (int)state.getSize());
+
+	juce::AudioBuffer<float> audio;
+	result = render(processor, sequence, settings, audio);
+
+	job.outputFile.deleteFile();
+	auto stream = std::make_unique<juce::FileOutputStream>(job.outputFile);
+	if (!stream->openedOk())
+	{
+		result.error = "Couldn't write " + job.outputFile.getFullPathName();
+		return result;
+	}
+
+	juce::WavAudioFormat wav;
+	std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), settings.sampleRate, (unsigned int)audio.getNumChannels(), settings.bitsPerSample, {}, 0));
+	if (writer == nullptr)
+	{
+		result.error = "Couldn't create a WAV writer for " + job.outputFile.getFullPathName();
+		return result;
+	}
+
+	// The writer owns the stream now
+	stream.release();
+
+	if (!writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples()))
+		result.error = "Couldn't write " + job.outputFile.getFullPathName();
+
+	return result;
+}
+
+std::vector<SulfuricOfflineRenderer::Result> SulfuricOfflineRenderer::renderJobs(const std::vector<Job>& jobs, const Settings& settings, int numThreads)
+{
+	std::vector<Result> results(jobs.size());
+	std::atomic<size_t> nextJob{ 0 };
+
+	// One render per thread already fills the cores, workers on top would only fight over them
+	auto batchSettings = settings;
+	batchSettings.useWorkerThreads = false;
+
+	auto worker = [&]
+	{
+		SulfuricAudioProcessor processor;
+
+		juce::MemoryBlock defaultState;
+		processor.getStateInformation(defaultState);
+
+		for (auto job = nextJob++; job < jobs.size(); job = nextJob++)
+			results[job] = renderJob(processor, jobs[job], batchSettings, defaultState);
+	};
+
+	std::vector<std::thread> threads;
+	for (auto i = 0; i < juce::jlimit(1, juce::jmax(1, (int)jobs.size()), numThreads); ++i)
+		threads.emplace_back(worker);
+
+	for (auto& thread : threads)
+		thread.join();
+
+	return results;
+}
+
+//==============================================================================
+juce::MidiMessageSequence SulfuricOfflineRenderer::getPreviewSequence()
+{
+	juce::MidiMessageSequence sequence;
+
+	for (auto note : { 48, 55, 60, 64 })
+	{
+		sequence.addEvent(juce::MidiMessage::noteOn(1, note, 0.8f), 0.0);
+		sequence.addEvent(juce::MidiMessage::noteOff(1, note), PREVIEW_HOLD_SECONDS);
+	}
+
+	sequence.updateMatchedPairs();
+	return sequence;
+}
+
+SulfuricOfflineRenderer::Audition SulfuricOfflineRenderer::analyse(const juce::AudioBuffer<float>& audio, double sampleRate)
+{
+	Audition audition;
+
+	// Every channel carries the same signal
+	auto* samples = audio.getReadPointer(0);
+	auto numSamples = audio.getNumSamples();
+	if (numSamples == 0)
+		return audition;
+
+	double sumSquares = 0.0, sumDifferenceSquares = 0.0;
+	auto previous = 0.0f;
+
+	for (auto i = 0; i < numSamples; ++i)
+	{
+		auto sample = samples[i];
+		sumSquares += (double)sample * sample;
+		sumDifferenceSquares += (double)(sample - previous) * (sample - previous);
+		audition.peak = juce::jmax(audition.peak, std::abs(sample));
+		previous = sample;
+	}
+
+	audition.rms = (float)std::sqrt(sumSquares / numSamples);
+	audition.brightness = sumSquares > 0.0 ? (float)std::sqrt(sumDifferenceSquares / sumSquares) : 0.0f;
+
+	for (auto i = 0; i < numSamples; ++i)
+	{
+		if (std::abs(samples[i]) >= audition.peak * 0.5f)
+		{
+			audition.attackSeconds = (float)(i / sampleRate);
+			break;
+		}
+	}
+
+	return audition;
+}
+
+SulfuricOfflineRenderer::Audition SulfuricOfflineRenderer::audition(SulfuricAudioProcessor& processor, juce::uint64 seed, const Settings& settings)
+{
+	SulfuricPatchGenerator::apply(seed, processor);
+
+	juce::AudioBuffer<float> audio;
+	render(processor, getPreviewSequence(), settings, audio);
+
+	auto audition = analyse(audio, settings.sampleRate);
+	audition.seed = seed;
+	return audition;
+}
+
+std::vector<SulfuricOfflineRenderer::Audition> SulfuricOfflineRenderer::auditionSeeds(juce::uint64 firstSeed, int numSeeds, const Settings& settings, int numThreads)
+{
+	std::vector<Audition> auditions((size_t)juce::jmax(0, numSeeds));
+	std::atomic<size_t> nextSeed{ 0 };
+
+	auto batchSettings = settings;
+	batchSettings.useWorkerThreads = false;
+
+	auto worker = [&]
+	{
+		SulfuricAudioProcessor processor;
+
+		for (auto index = nextSeed++; index < auditions.size(); index = nextSeed++)
+			auditions[index] = audition(processor, firstSeed + index, batchSettings);
+	};
+
+	std::vector<std::thread> threads;
+	for (auto i = 0; i < juce::jlimit(1, juce::jmax(1, numSeeds), numThreads); ++i)
+		threads.emplace_back(worker);
+
+	for (auto& thread : threads)
+		thread.join();
+
+	return auditions;
+}
\ No newline at end of file
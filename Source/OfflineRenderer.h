@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+	Renders MIDI files through SulfuricAudioProcessor without a host.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <optional>
+
+#include "PluginSynthesiser.h"
+
+//==============================================================================
+class SulfuricOfflineRenderer
+{
+public:
+	struct Settings
+	{
+		double sampleRate = 48000.0;
+		int blockSize = 512;
+
+		// Keeps rendering this long after the last MIDI event, so releases can ring out.
+		// Unset, it's the processor's getTailLengthSeconds() once its state is applied, so the whole release fits.
+		std::optional<double> tailSeconds;
+		int bitsPerSample = 24;
+
+		// Spreads one render's buses and voices over the shared worker threads. Batches turn it off, they already have a thread per render.
+		bool useWorkerThreads = true;
+	};
+
+	struct Job
+	{
+		juce::File midiFile, outputFile;
+
+		// Written by getStateInformation, the default state is used if this doesn't exist
+		juce::File stateFile;
+	};
+
+	struct Result
+	{
+		juce::String error;
+		double audioSeconds = 0.0, renderSeconds = 0.0;
+
+		bool wasOk() const noexcept { return error.isEmpty(); }
+		double getRealtimeFactor() const noexcept { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+	};
+
+	/** Merges every track of a Standard MIDI File into one sequence timed in seconds. */
+	static bool readMidiFile(const juce::File&, juce::MidiMessageSequence&, juce::String& error);
+
+	/** Renders a sequence into a buffer sized to fit, only the processBlock calls are timed. */
+	static Result render(SulfuricAudioProcessor&, const juce::MidiMessageSequence&, const Settings&, juce::AudioBuffer<float>& output);
+
+	/** Runs one job start to finish on the calling thread, reusing the given processor. */
+	static Result renderJob(SulfuricAudioProcessor&, const Job&, const Settings&, const juce::MemoryBlock& defaultState);
+
+	/**
+		Runs every job across numThreads threads, each owning one processor instance that renders on its own thread alone.
+		Results come back in the same order as the jobs.
+	*/
+	static std::vector<Result> renderJobs(const std::vector<Job>&, const Settings&, int numThreads);
+
+	//==============================================================================
+	/** Cheap features of one seed's preview, for ranking seeds against each other. */
+	struct Audition
+	{
+		juce::uint64 seed = 0;
+
+		float rms = 0.0f, peak = 0.0f;
+
+		// RMS of the first difference over RMS: about 2 pi f / sample rate for a sine, so higher is brighter
+		float brightness = 0.0f;
+
+		// Until the preview first reaches half its peak
+		float attackSeconds = 0.0f;
+	};
+
+	/** Holds a chord for PREVIEW_HOLD_SECONDS, then lets it ring for the settings' or the patch's tail. */
+	static juce::MidiMessageSequence getPreviewSequence();
+	constexpr static double PREVIEW_HOLD_SECONDS = 1.0;
+
+	static Audition analyse(const juce::AudioBuffer<float>&, double sampleRate);
+
+	/** Generates the seed's patch on the processor and renders and analyses its preview. */
+	static Audition audition(SulfuricAudioProcessor&, juce::uint64 seed, const Settings&);
+
+	/** Auditions numSeeds consecutive seeds across numThreads threads, one processor each rendering on its own thread alone, results in seed order. */
+	static std::vector<Audition> auditionSeeds(juce::uint64 firstSeed, int numSeeds, const Settings&, int numThreads);
+};
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+	Band-limited wavetables, and the note frequencies voices play them at.
+
+  ==============================================================================
+*/
+
+#include "Oscillator.h"
+#include "TableCache.h"
+
+#include <cmath>
+#include <numbers>
+
+//==============================================================================
+SulfuricWavetable::SulfuricWavetable(const std::vector<float>& harmonicAmplitudes)
+	: numHarmonics((int)harmonicAmplitudes.size())
+{
+	// Level n keeps numHarmonics >> n harmonics, down to the bare fundamental
+	for (auto harmonics = numHarmonics; ; harmonics /= 2)
+	{
+		std::vector<double> cycle(SIZE, 0.0);
+
+		for (auto h = 0; h < harmonics; ++h)
+		{
+			auto amplitude = (double)harmonicAmplitudes[(size_t)h];
+			if (amplitude == 0.0)
+				continue;
+
+			for (auto i = 0; i < SIZE; ++i)
+				cycle[(size_t)i] += amplitude * std::sin(2.0 * std::numbers::pi * (double)(h + 1) * i / SIZE);
+		}
+
+		for (auto i = -1; i < SIZE + 2; ++i)
+			samples.push_back((float)cycle[(size_t)((i + SIZE) % SIZE)]);
+
+		++numLevels;
+
+		if (harmonics <= 1)
+			break;
+	}
+}
+
+std::shared_ptr<const SulfuricWavetable> SulfuricWavetable::getSine()
+{
+	return SulfuricTableCache::get<SulfuricWavetable>("sine", [] { return SulfuricWavetable({ 1.0f }); });
+}
+
+int SulfuricWavetable::getLevelForIncrement(uint32_t phaseIncrement) const noexcept
+{
+	if (phaseIncrement == 0)
+		return 0;
+
+	// Harmonic h sits at h * increment, which has to stay below half a cycle per sample
+	auto allowedHarmonics = (int)((1ull << 31) / phaseIncrement);
+
+	auto level = 0;
+	while ((numHarmonics >> level) > allowedHarmonics && level < getNumLevels() - 1)
+		++level;
+
+	return level;
+}
+
+uint32_t SulfuricWavetable::incrementForFrequency(double frequency, double sampleRate) noexcept
+{
+	auto cyclesPerSample = frequency / sampleRate;
+	return (uint32_t)(int64_t)std::llround((cyclesPerSample - std::floor(cyclesPerSample)) * 4294967296.0);
+}
+
+//==============================================================================
+SulfuricNoteTable::SulfuricNoteTable()
+{
+	for (auto note = 0; note < 128; ++note)
+		frequencies[(size_t)note] = 440.0 * std::exp2((note - 69) / 12.0);
+}
+
+std::shared_ptr<const SulfuricNoteTable> SulfuricNoteTable::getShared()
+{
+	return SulfuricTableCache::get<SulfuricNoteTable>("notes", [] { return SulfuricNoteTable(); });
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+	Band-limited wavetables, and the note frequencies voices play them at.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/** How an oscillator produces its waveform. */
+enum class OscillatorQuality
+{
+	exact,		// std::sin once per sample, the reference every other mode is measured against
+	phasor,		// Recursive quadrature rotation, pure sines only
+	cubic,		// 4-point Hermite interpolation of the shared wavetable
+	linear		// 2-point linear interpolation of the shared wavetable
+};
+
+//==============================================================================
+/**
+	A single-cycle waveform stored as one table per octave. Each table only contains
+	the harmonics that stay below Nyquist for the fundamentals it is used for, so
+	reading it at any pitch never aliases.
+
+	Tables are immutable once built and are meant to be shared by every voice, and
+	through SulfuricTableCache by every plugin instance.
+*/
+class SulfuricWavetable
+{
+public:
+	/** amplitudes[0] is the fundamental, amplitudes[1] the 2nd harmonic and so on. */
+	explicit SulfuricWavetable(const std::vector<float>& harmonicAmplitudes);
+
+	/** The process-wide sine table. Takes a lock, so hold on to it rather than asking on the audio thread. */
+	static std::shared_ptr<const SulfuricWavetable> getSine();
+
+	const static int SIZE_BITS = 11;
+	const static int SIZE = 1 << SIZE_BITS;
+
+	// A 32 bit phase accumulator spans one cycle, its top SIZE_BITS bits are the table index
+	const static int FRACTION_BITS = 32 - SIZE_BITS;
+	const static uint32_t FRACTION_MASK = (1u << FRACTION_BITS) - 1;
+
+	// Every level is stored with one guard point before the cycle and two after it
+	const static int LEVEL_STRIDE = SIZE + 3;
+
+	/** Picks the table with the most harmonics that still fit below Nyquist. */
+	int getLevelForIncrement(uint32_t phaseIncrement) const noexcept;
+	int getNumLevels() const noexcept { return numLevels; }
+
+	/** Samples [-1, SIZE + 1] are valid, so interpolators never have to wrap. */
+	const float* getLevel(int level) const noexcept { return samples.data() + level * LEVEL_STRIDE + 1; }
+
+	static uint32_t incrementForFrequency(double frequency, double sampleRate) noexcept;
+
+	size_t getMemoryUsage() const noexcept { return sizeof(*this) + samples.capacity() * sizeof(float); }
+
+	inline static float readLinear(const float* table, uint32_t phase) noexcept
+	{
+		auto index = phase >> FRACTION_BITS;
+		auto fraction = (float)(phase & FRACTION_MASK) * (1.0f / (float)(1u << FRACTION_BITS));
+		auto a = table[index];
+		return a + fraction * (table[index + 1] - a);
+	}
+
+	inline static float readCubic(const float* table, uint32_t phase) noexcept
+	{
+		auto index = (int)(phase >> FRACTION_BITS);
+		auto t = (float)(phase & FRACTION_MASK) * (1.0f / (float)(1u << FRACTION_BITS));
+		auto y0 = table[index - 1], y1 = table[index], y2 = table[index + 1], y3 = table[index + 2];
+
+		// 4-point, 3rd-order Hermite
+		auto c1 = 0.5f * (y2 - y0);
+		auto c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+		auto c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+		return ((c3 * t + c2) * t + c1) * t + y1;
+	}
+
+private:
+	int numHarmonics, numLevels = 0;
+
+	// All levels live in one allocation, so SIMD code can gather from any of them off a single base pointer
+	std::vector<float> samples;
+};
+
+//==============================================================================
+/** Equal-tempered frequencies of every MIDI note, A4 = 440 Hz. */
+class SulfuricNoteTable
+{
+public:
+	SulfuricNoteTable();
+
+	/** The process-wide table, see getSine() about the lock. */
+	static std::shared_ptr<const SulfuricNoteTable> getShared();
+
+	double getFrequency(int midiNoteNumber) const noexcept { return frequencies[(size_t)(midiNoteNumber & 127)]; }
+
+	size_t getMemoryUsage() const noexcept { return sizeof(*this); }
+
+private:
+	std::array<double, 128> frequencies;
+};
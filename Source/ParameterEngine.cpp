@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+	Reads every parameter once per block and smooths the ones that move,
+	SimdFloat::WIDTH parameters at a time.
+
+  ==============================================================================
+*/
+
+#include "ParameterEngine.h"
+
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+int SulfuricParameterEngine::add(const std::atomic<float>* source, Smoothing newSmoothing, double seconds)
+{
+	sources.push_back(source);
+	smoothing.push_back(seconds > 0.0 ? newSmoothing : Smoothing::none);
+	smoothingSeconds.push_back(seconds);
+	return (int)sources.size() - 1;
+}
+
+void SulfuricParameterEngine::prepare(double sampleRate, int newMaxBlockSize)
+{
+	auto numParameters = sources.size();
+	numGroups = (int)((numParameters + SimdFloat::WIDTH - 1) / SimdFloat::WIDTH);
+	maxBlockSize = std::max(1, newMaxBlockSize);
+
+	auto padded = (size_t)(numGroups * SimdFloat::WIDTH);
+
+	for (auto* array : { &target, &value, &distance, &x, &step })
+		array->assign(padded, 0.0f);
+
+	decay.assign(padded, 1.0f);
+	moving.assign(padded, 0);
+	ramps.assign(padded * (size_t)maxBlockSize, 0.0f);
+
+	for (size_t index = 0; index < numParameters; ++index)
+	{
+		auto samples = smoothingSeconds[index] * sampleRate;
+
+		switch (smoothing[index])
+		{
+		case Smoothing::linear:
+			step[index] = (float)(1.0 / std::max(1.0, std::round(samples)));
+			break;
+		case Smoothing::exponential:
+			decay[index] = (float)std::exp(-1.0 / std::max(1.0, samples));
+			break;
+		case Smoothing::none:
+			break;
+		}
+
+		target[index] = value[index] = sources[index]->load(std::memory_order_relaxed);
+	}
+}
+
+size_t SulfuricParameterEngine::getMemoryUsage() const noexcept
+{
+	auto bytes = sizeof(*this) + sources.capacity() * sizeof(sources[0]) + smoothing.capacity() * sizeof(Smoothing)
+		+ smoothingSeconds.capacity() * sizeof(double) + moving.capacity() * sizeof(uint8_t) + ramps.capacity() * sizeof(float);
+
+	for (auto* array : { &target, &value, &distance, &x, &decay, &step })
+		bytes += array->capacity() * sizeof(float);
+
+	return bytes;
+}
+
+void SulfuricParameterEngine::setTarget(size_t index, float newTarget) noexcept
+{
+	target[index] = newTarget;
+
+	if (smoothing[index] == Smoothing::none)
+	{
+		value[index] = newTarget;
+		distance[index] = 0.0f;
+		x[index] = 0.0f;
+		return;
+	}
+
+	// Restart the curve from wherever it has got to
+	distance[index] = newTarget - value[index];
+	x[index] = 1.0f;
+}
+
+void SulfuricParameterEngine::process(int numSamples) noexcept
+{
+	for (size_t index = 0; index < sources.size(); ++index)
+	{
+		auto newTarget = sources[index]->load(std::memory_order_relaxed);
+		if (newTarget != target[index])
+			setTarget(index, newTarget);
+	}
+
+	const auto rampLength = std::min(numSamples, maxBlockSize);
+
+	for (auto group = 0; group < numGroups; ++group)
+	{
+		const auto first = (size_t)(group * SimdFloat::WIDTH);
+
+		auto anyMoving = false;
+		for (auto lane = first; lane < first + SimdFloat::WIDTH; ++lane)
+		{
+			moving[lane] = x[lane] > 0.0f ? 1 : 0;
+			anyMoving |= moving[lane] != 0;
+		}
+
+		// Settled, so skip the whole group
+		if (!anyMoving)
+			continue;
+
+		const auto targets = SimdFloat::load(&target[first]);
+		const auto distances = SimdFloat::load(&distance[first]);
+		const auto decays = SimdFloat::load(&decay[first]);
+		const auto steps = SimdFloat::load(&step[first]);
+		const auto zero = SimdFloat::broadcast(0.0f);
+
+		auto position = SimdFloat::load(&x[first]);
+		auto* ramp = ramps.data() + first * (size_t)maxBlockSize;
+
+		for (auto i = 0; i < rampLength; ++i, ramp += SimdFloat::WIDTH)
+		{
+			position = SimdFloat::max(position * decays - steps, zero);
+			(targets - distances * position).store(ramp);
+		}
+
+		position.store(&x[first]);
+
+		for (auto lane = first; lane < first + SimdFloat::WIDTH; ++lane)
+		{
+			// Whatever didn't fit in the ramp still has to happen
+			for (auto i = rampLength; i < numSamples && x[lane] > 0.0f; ++i)
+				x[lane] = std::max(x[lane] * decay[lane] - step[lane], 0.0f);
+
+			if (x[lane] < SETTLED)
+				x[lane] = 0.0f;
+
+			value[lane] = target[lane] - distance[lane] * x[lane];
+		}
+	}
+}
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+	Reads every parameter once per block and smooths the ones that move,
+	SimdFloat::WIDTH parameters at a time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Simd.h"
+
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/**
+	Every smoothed parameter follows value = target - distance * x, with x falling
+	from 1 to 0 as x = max(x * decay - step, 0) each sample. That is a straight
+	line for linear smoothing (decay 1) and a one-pole curve for exponential
+	(step 0), so both kinds share one SIMD loop, one parameter per lane.
+
+	A group of lanes where nothing is moving costs a comparison per block, so
+	heavy automation of a few parameters costs the same as automating all of them,
+	and nothing at all once they settle.
+*/
+class SulfuricParameterEngine
+{
+public:
+	enum class Smoothing : uint8_t { none, linear, exponential };
+
+	/**
+		Registers a parameter before prepare(), returning its index. seconds is the
+		ramp length for linear smoothing, the time constant for exponential.
+	*/
+	int add(const std::atomic<float>* source, Smoothing = Smoothing::none, double seconds = 0.0);
+
+	/** Allocates the ramps and jumps straight to every parameter's current value. Call it off the audio thread. */
+	void prepare(double sampleRate, int maxBlockSize);
+
+	/** Loads every atomic once and smooths over numSamples. Ramps hold at most getMaxBlockSize() samples. */
+	void process(int numSamples) noexcept;
+
+	int getNumParameters() const noexcept { return (int)sources.size(); }
+	int getMaxBlockSize() const noexcept { return maxBlockSize; }
+
+	/** Where the parameter got to by the end of the last block. */
+	float getValue(int index) const noexcept { return value[(size_t)index]; }
+
+	/** True if the parameter moved during the last block, and so has a ramp. */
+	bool isSmoothing(int index) const noexcept { return moving[(size_t)index] != 0; }
+
+	/** A parameter's samples, SimdFloat::WIDTH floats apart since every ramp is interleaved with the rest of its group. */
+	struct Ramp
+	{
+		const float* samples;
+
+		float operator[](int sample) const noexcept { return samples[(size_t)sample * SimdFloat::WIDTH]; }
+	};
+
+	/** The parameter's value at every sample of the last block, only filled in while isSmoothing(). */
+	Ramp getRamp(int index) const noexcept
+	{
+		auto group = (size_t)index / SimdFloat::WIDTH, lane = (size_t)index % SimdFloat::WIDTH;
+		return { ramps.data() + group * (size_t)maxBlockSize * SimdFloat::WIDTH + lane };
+	}
+
+	size_t getMemoryUsage() const noexcept;
+
+private:
+	void setTarget(size_t index, float newTarget) noexcept;
+
+	// A curve this close to its target has arrived
+	constexpr static float SETTLED = 1.0e-4f;
+
+	std::vector<const std::atomic<float>*> sources;
+	std::vector<Smoothing> smoothing;
+	std::vector<double> smoothingSeconds;
+
+	// Padded to whole SIMD groups, see the class description
+	std::vector<float> target, value, distance, x, decay, step;
+	std::vector<uint8_t> moving;
+
+	// maxBlockSize vectors per group, each holding one sample of every lane, so the smoothing loop stores them whole
+	std::vector<float> ramps;
+
+	int numGroups = 0, maxBlockSize = 0;
+};
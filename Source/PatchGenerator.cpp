@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+	Turns a 64-bit seed into a complete patch, the same one on every machine.
+
+  ==============================================================================
+*/
+
+#include "PatchGenerator.h"
+#include "StateFormat.h"
+
+//==============================================================================
+namespace
+{
+	// SplitMix64's finaliser, so neighbouring seeds give unrelated patches
+	juce::uint64 mix(juce::uint64 x) noexcept
+	{
+		x += 0x9e3779b97f4a7c15ull;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+		return x ^ (x >> 31);
+	}
+
+	/**
+		How far from its default a parameter may wander, as a fraction of its range.
+		Most take anything, pitch mostly stays near home so patches stay playable.
+	*/
+	float getSpread(const juce::String& parameterID) noexcept
+	{
+		if (parameterID == "tune")
+			return 0.5f;
+		if (parameterID == "fine")
+			return 0.2f;
+		return 1.0f;
+	}
+}
+
+//==============================================================================
+float SulfuricPatchGenerator::getUniform(juce::uint64 seed, juce::uint32 stream) noexcept
+{
+	return (float)(mix(seed ^ mix(stream)) >> 40) * (1.0f / 16777216.0f);
+}
+
+float SulfuricPatchGenerator::getValue(juce::uint64 seed, const juce::RangedAudioParameter& parameter) noexcept
+{
+	auto stream = SulfuricStateFormat::hashParameterID(parameter.paramID);
+	auto spread = getSpread(parameter.paramID);
+
+	if (spread >= 1.0f)
+		return getUniform(seed, stream);
+
+	// Triangular around the default, two draws averaged
+	auto offset = getUniform(seed, stream) + getUniform(seed, ~stream) - 1.0f;
+	return juce::jlimit(0.0f, 1.0f, parameter.getDefaultValue() + offset * spread);
+}
+
+void SulfuricPatchGenerator::apply(juce::uint64 seed, SulfuricAudioProcessor& processor)
+{
+	for (auto* parameter : processor.getPatchParameters())
+		parameter->setValueNotifyingHost(getValue(seed, *parameter));
+}
@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+	Turns a 64-bit seed into a complete patch, the same one on every machine.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "PluginSynthesiser.h"
+
+//==============================================================================
+/**
+	Every patch parameter gets its own value from a hash of the seed and the
+	parameter's ID, not from one shared random stream. Adding a parameter later
+	leaves the values every existing seed gives the others untouched.
+
+	Only integer arithmetic goes into the random part, so a seed sounds the same
+	whatever the platform or compiler.
+*/
+class SulfuricPatchGenerator
+{
+public:
+	/** The normalised value seed gives the parameter with this ID. */
+	static float getValue(juce::uint64 seed, const juce::RangedAudioParameter&) noexcept;
+
+	/** Sets every patch parameter of the processor from seed, notifying the host. Cheap enough for a button press. */
+	static void apply(juce::uint64 seed, SulfuricAudioProcessor&);
+
+	/** Uniform in [0, 1), 24 bits of it. */
+	static float getUniform(juce::uint64 seed, juce::uint32 stream) noexcept;
+};
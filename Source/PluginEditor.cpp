@@ -1,139 +1,331 @@
-/*
-  ==============================================================================
-
-	This file contains the basic framework code for a JUCE plugin editor.
-
-  ==============================================================================
-*/
-
-#include "PluginSynthesiser.h"
-#include "PluginEditor.h"
-#include "BinaryData.h"
-
-//==============================================================================
-SulfuricAudioProcessorEditor::SulfuricAudioProcessorEditor(SulfuricAudioProcessor& p, juce::AudioProcessorValueTreeState& vts)
-	: AudioProcessorEditor(&p), audioProcessor(p), valueTreeState(vts)
-{
-	// Make sure that before the constructor has finished, you've set the
-	// editor's size to whatever you need it to be.
-	setSize(WIDTH, HEIGHT);
-	setResizable(true, false);
-
-	masterAttachment.reset(new SliderAttachment(valueTreeState, "master", masterSlider));
-	addAndMakeVisible(masterSlider);
-	configureRotary(masterSlider);
-
-	for (auto &knob : parameterKnobs)
-	{
-		addAndMakeVisible(knob);
-		configureRotary(knob);
-	}
-
-	addAndMakeVisible(resetButton);
-	juce::Image resetBtnImage = juce::ImageFileFormat::loadFrom(BinaryData::resetbtn_png, (size_t)BinaryData::resetbtn_pngSize);
-	juce::Image resetBtnPressedImage = juce::ImageFileFormat::loadFrom(BinaryData::resetbtnpressed_png, (size_t)BinaryData::resetbtnpressed_pngSize);
-	resetButton.setImages(
-		false, true, true,
-		resetBtnImage, 1, juce::Colours::transparentBlack,
-		resetBtnImage, 1, juce::Colours::transparentBlack,
-		resetBtnPressedImage, 1, juce::Colours::transparentBlack
-	);
-
-	addAndMakeVisible(monoButton);
-	addAndMakeVisible(monoButtonLabel);
-	configureButton(monoButton, true);
-
-	addAndMakeVisible(presetButton);
-	addAndMakeVisible(presetButtonLabel);
-	configureButton(presetButton, true);
-
-	addAndMakeVisible(saveButton);
-	addAndMakeVisible(saveButtonLabel);
-	configureButton(saveButton, false);
-
-	addAndMakeVisible(seedLabel);
-
-	std::ostringstream hexBuffer;
-	hexBuffer << std::hex << randomizeSeed();
-	seedLabel.setText(juce::String(hexBuffer.str()), juce::NotificationType::sendNotification);
-}
-
-SulfuricAudioProcessorEditor::~SulfuricAudioProcessorEditor() {}
-
-//==============================================================================
-void SulfuricAudioProcessorEditor::paint(juce::Graphics& g)
-{
-	// (Our component is opaque, so we must completely fill the background with a solid colour)
-	g.fillAll(metalGrey);
-}
-
-void SulfuricAudioProcessorEditor::resized()
-{
-	masterSlider.setBounds(WIDTH - SMALL_SPACE * 2, SMALL_SPACE + SMALL_BUTTON, SMALL_ROTARY_W, SMALL_ROTARY_H);
-
-	// 3.5 should be 4 (Move the button 1 quarter to the right to center it), but the rotary knob does not visually fit into its bounding box, so 3.5 works better
-	monoButton.setBounds(WIDTH - SMALL_SPACE * 2 + SMALL_ROTARY_W / 3.5, SMALL_SPACE, SMALL_BUTTON, SMALL_BUTTON);
-	monoButtonLabel.setBounds(WIDTH - SMALL_SPACE * 2 + SMALL_ROTARY_W / 10, SMALL_SPACE - SMALL_BUTTON, SMALL_TEXT_W, SMALL_TEXT_H);
-
-	resetButton.setBounds(WIDTH / 2 + WIDTH / 4 - LARGE_BUTTON / 2, HEIGHT / 4 - LARGE_BUTTON / 2, LARGE_BUTTON, LARGE_BUTTON);
-
-	presetButton.setBounds(KNOB_SPACING, HEIGHT / 2 - SMALL_ROTARY_H, SMALL_BUTTON, SMALL_BUTTON);
-	presetButtonLabel.setBounds(KNOB_SPACING, HEIGHT / 2 - SMALL_ROTARY_H - SMALL_BUTTON, SMALL_TEXT_W, SMALL_TEXT_H);
-
-	saveButton.setBounds(KNOB_SPACING + KNOB_SPACING / 2, HEIGHT / 2 - SMALL_ROTARY_H, SMALL_BUTTON, SMALL_BUTTON);
-	saveButtonLabel.setBounds(KNOB_SPACING + KNOB_SPACING / 2, HEIGHT / 2 - SMALL_ROTARY_H - SMALL_BUTTON, SMALL_TEXT_W, SMALL_TEXT_H);
-
-	seedLabel.setBounds(SMALL_SPACE, 0, LARGE_TEXT_W, LARGE_TEXT_H);
-
-	int currentRow = -1;
-	for (size_t a = 0; a < KNOB_COUNT; a++)
-	{
-		if (a % KNOBS_PER_ROW == 0)
-			currentRow += 1;
-
-		parameterKnobs[a].setBounds(KNOB_SPACING + (KNOB_SPACING + SMALL_ROTARY_W) * (a % KNOBS_PER_ROW), HEIGHT / 2 + SMALL_ROTARY_H * currentRow, SMALL_ROTARY_W, SMALL_ROTARY_H);
-	}
-
-	//DBG(
-	//	"WIDTH: " << WIDTH << " HEIGHT: " << HEIGHT << "\n"
-	//	<< " SMALL_SPACE: " << SMALL_SPACE << "\n"
-	//	<< " SMALL_TEXT_W: " << SMALL_TEXT_W << " SMALL_TEXT_H: " << SMALL_TEXT_H << "\n"
-	//	<< " SMALL_ROTARY_W: " << SMALL_ROTARY_W << " SMALL_ROTARY_H: " << SMALL_ROTARY_H << "\n"
-	//	<< "KNOB_SPACING: " << KNOB_SPACING
-	//);
-}
-
-void SulfuricAudioProcessorEditor::configureRotary(juce::Slider &slider)
-{
-	slider.setSliderStyle(juce::Slider::Rotary);
-	slider.setRotaryParameters(0, juce::MathConstants<float>::twoPi, true);
-	slider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, SMALL_TEXT_W, SMALL_TEXT_H);
-	slider.setColour(juce::Slider::textBoxOutlineColourId, metalGrey);
-	slider.setColour(juce::Slider::rotarySliderOutlineColourId, offWhite);
-	slider.setColour(juce::Slider::textBoxBackgroundColourId, brightMetalGrey);
-	slider.setColour(juce::Slider::textBoxTextColourId, offWhite);
-	slider.setColour(juce::Slider::rotarySliderOutlineColourId, metalGrey);
-	slider.setColour(juce::Slider::rotarySliderFillColourId, brightMetalGrey);
-	slider.setColour(juce::Slider::backgroundColourId, metalGrey);
-	slider.setColour(juce::Slider::thumbColourId, offWhite);
-	slider.setPopupDisplayEnabled(false, false, this);
-}
-
-void SulfuricAudioProcessorEditor::configureButton(juce::ShapeButton& button, bool isToggle)
-{
-	juce::Path smallCircle = juce::Path();
-	smallCircle.addEllipse(0, 0, SMALL_BUTTON, SMALL_BUTTON);
-	button.setShape(smallCircle, true, true, false);
-	button.setClickingTogglesState(isToggle);
-	button.setColours(brightMetalGrey, brightMetalGrey, isToggle ? brightMetalGrey : offWhite);
-	button.setOnColours(offWhite, offWhite, offWhite);
-	button.shouldUseOnColours(true);
-}
-
-uint64_t SulfuricAudioProcessorEditor::randomizeSeed()
-{
-	rng.setSeedRandomly();
-
-	// Display the seed as if it were unsigned
-	return (uint64_t)rng.getSeed();
+/*
+  ==============================================================================
+
+	This file contains the basic framework code for a JUCE plugin editor.
+
+  ==============================================================================
+*/
+
+#include "PluginSynthesiser.h"
+#include "PluginEditor.h"
+#include "PatchGenerator.h"
+#include "BinaryData.h"
+
+//==============================================================================
+SulfuricAudioProcessorEditor::SulfuricAudioProcessorEditor(SulfuricAudioProcessor& p, juce::AudioProcessorValueTreeState& vts)
+	: AudioProcessorEditor(&p), audioProcessor(p), valueTreeState(vts)
+{
+	// Make sure that before the constructor has finished, you've set the
+	// editor's size to whatever you need it to be.
+	setSize(WIDTH, HEIGHT);
+	setResizable(true, false);
+	setResizeLimits(WIDTH / 2, HEIGHT / 2, WIDTH * 2, HEIGHT * 2);
+	getConstrainer()->setFixedAspectRatio((double)WIDTH / HEIGHT);
+
+	// Nothing behind the editor ever needs repainting for it
+	setOpaque(true);
+}
+
+SulfuricAudioProcessorEditor::~SulfuricAudioProcessorEditor() {}
+
+//==============================================================================
+void SulfuricAudioProcessorEditor::createChildren()
+{
+	hasChildren = true;
+
+	masterAttachment.reset(new SliderAttachment(valueTreeState, "master", masterSlider));
+	addAndMakeVisible(masterSlider);
+	configureRotary(masterSlider);
+
+	// Knobs left over once every patch parameter has one stay greyed out
+	auto& patchParameters = audioProcessor.getPatchParameters();
+
+	for (size_t a = 0; a < KNOB_COUNT; a++)
+	{
+		auto& knob = parameterKnobs[a];
+		auto& label = parameterKnobLabels[a];
+
+		addAndMakeVisible(knob);
+		configureRotary(knob);
+
+		addAndMakeVisible(label);
+		label.setJustificationType(juce::Justification::centred);
+		label.setColour(juce::Label::textColourId, offWhite);
+		label.setBufferedToImage(true);
+
+		if ((int)a < patchParameters.size())
+		{
+			auto* parameter = patchParameters[(int)a];
+			parameterKnobAttachments[a].reset(new SliderAttachment(valueTreeState, parameter->paramID, knob));
+			label.setText(parameter->getName(SMALL_TEXT_W).toUpperCase(), juce::NotificationType::dontSendNotification);
+		}
+		else
+		{
+			knob.setEnabled(false);
+		}
+	}
+
+	addAndMakeVisible(resetButton);
+	// Decoded once and shared by every editor in the process, JUCE's cache keeps them a while after the last one closes
+	juce::Image resetBtnImage = juce::ImageCache::getFromMemory(BinaryData::resetbtn_png, BinaryData::resetbtn_pngSize);
+	juce::Image resetBtnPressedImage = juce::ImageCache::getFromMemory(BinaryData::resetbtnpressed_png, BinaryData::resetbtnpressed_pngSize);
+	resetButton.setImages(
+		false, true, true,
+		resetBtnImage, 1, juce::Colours::transparentBlack,
+		resetBtnImage, 1, juce::Colours::transparentBlack,
+		resetBtnPressedImage, 1, juce::Colours::transparentBlack
+	);
+	resetButton.setBufferedToImage(true);
+
+	addAndMakeVisible(monoButton);
+	addAndMakeVisible(monoButtonLabel);
+	monoButtonLabel.setBufferedToImage(true);
+	configureButton(monoButton, true);
+
+	addAndMakeVisible(presetButton);
+	addAndMakeVisible(presetButtonLabel);
+	presetButtonLabel.setBufferedToImage(true);
+	configureButton(presetButton, true);
+
+	// With PRE on, the reset button steps through the saved presets instead of rolling new patches
+	presetButton.onClick = [this] { if (presetButton.getToggleState()) showPreset(juce::jmax(0, currentPreset)); };
+	resetButton.onClick = [this]
+	{
+		if (presetButton.getToggleState())
+			showPreset(currentPreset + 1);
+		else
+			generatePatch();
+	};
+
+	addAndMakeVisible(saveButton);
+	addAndMakeVisible(saveButtonLabel);
+	saveButtonLabel.setBufferedToImage(true);
+	configureButton(saveButton, false);
+	saveButton.onClick = [this] { savePreset(); };
+
+	openPresetBank(-1);
+
+	// Blank until a seed is rolled or a preset shown, nothing says where the loaded patch came from
+	addAndMakeVisible(seedLabel);
+
+	scopeView = std::make_unique<SulfuricScopeView>(audioProcessor.getScopeFeed(), metalGrey.darker(0.5f), offYellow);
+	addAndMakeVisible(*scopeView);
+
+	addAndMakeVisible(loadLabel);
+	loadLabel.setJustificationType(juce::Justification::centredRight);
+	loadLabel.setColour(juce::Label::textColourId, offWhite);
+	startTimerHz(LOAD_METER_HZ);
+}
+
+//==============================================================================
+void SulfuricAudioProcessorEditor::paint(juce::Graphics& g)
+{
+	// (Our component is opaque, so we must completely fill the background with a solid colour)
+	g.fillAll(metalGrey);
+}
+
+void SulfuricAudioProcessorEditor::visibilityChanged()
+{
+	if (isVisible() && !hasChildren)
+	{
+		createChildren();
+		resized();
+	}
+}
+
+void SulfuricAudioProcessorEditor::resized()
+{
+	// The constructor's setSize() gets here before anything has been built
+	if (!hasChildren)
+		return;
+
+	masterSlider.setBounds(WIDTH - SMALL_SPACE * 2, SMALL_SPACE + SMALL_BUTTON, SMALL_ROTARY_W, SMALL_ROTARY_H);
+
+	// 3.5 should be 4 (Move the button 1 quarter to the right to center it), but the rotary knob does not visually fit into its bounding box, so 3.5 works better
+	monoButton.setBounds(WIDTH - SMALL_SPACE * 2 + SMALL_ROTARY_W / 3.5, SMALL_SPACE, SMALL_BUTTON, SMALL_BUTTON);
+	monoButtonLabel.setBounds(WIDTH - SMALL_SPACE * 2 + SMALL_ROTARY_W / 10, SMALL_SPACE - SMALL_BUTTON, SMALL_TEXT_W, SMALL_TEXT_H);
+
+	resetButton.setBounds(WIDTH / 2 + WIDTH / 4 - LARGE_BUTTON / 2, HEIGHT / 4 - LARGE_BUTTON / 2, LARGE_BUTTON, LARGE_BUTTON);
+
+	presetButton.setBounds(KNOB_SPACING, HEIGHT / 2 - SMALL_ROTARY_H, SMALL_BUTTON, SMALL_BUTTON);
+	presetButtonLabel.setBounds(KNOB_SPACING, HEIGHT / 2 - SMALL_ROTARY_H - SMALL_BUTTON, SMALL_TEXT_W, SMALL_TEXT_H);
+
+	saveButton.setBounds(KNOB_SPACING + KNOB_SPACING / 2, HEIGHT / 2 - SMALL_ROTARY_H, SMALL_BUTTON, SMALL_BUTTON);
+	saveButtonLabel.setBounds(KNOB_SPACING + KNOB_SPACING / 2, HEIGHT / 2 - SMALL_ROTARY_H - SMALL_BUTTON, SMALL_TEXT_W, SMALL_TEXT_H);
+
+	seedLabel.setBounds(SMALL_SPACE, 0, LARGE_TEXT_W, LARGE_TEXT_H);
+
+	loadLabel.setBounds(WIDTH - SMALL_SPACE - LARGE_TEXT_W, 0, LARGE_TEXT_W, MEDIUM_TEXT_H);
+
+	// Between the seed and the preset buttons, up to the middle
+	scopeView->setBounds(SMALL_SPACE, LARGE_TEXT_H, WIDTH / 2 - SMALL_SPACE, HEIGHT / 2 - SMALL_ROTARY_H - SMALL_BUTTON * 2 - LARGE_TEXT_H);
+
+	// Each knob has its name above it
+	int currentRow = -1;
+	for (size_t a = 0; a < KNOB_COUNT; a++)
+	{
+		if (a % KNOBS_PER_ROW == 0)
+			currentRow += 1;
+
+		auto x = KNOB_SPACING + (KNOB_SPACING + SMALL_ROTARY_W) * (a % KNOBS_PER_ROW);
+		auto y = HEIGHT / 2 + (SMALL_ROTARY_H + SMALL_TEXT_H) * currentRow;
+
+		parameterKnobLabels[a].setBounds(x - KNOB_SPACING / 2, y, SMALL_ROTARY_W + KNOB_SPACING, SMALL_TEXT_H);
+		parameterKnobs[a].setBounds(x, y + SMALL_TEXT_H, SMALL_ROTARY_W, SMALL_ROTARY_H);
+	}
+
+	// Everything above is laid out at WIDTH x HEIGHT, then scaled as a whole to the size the host gave us.
+	// Buffered children re-render their cached images at the new scale, so nothing turns blurry.
+	auto scale = juce::jmin((float)getWidth() / WIDTH, (float)getHeight() / HEIGHT);
+	for (auto* child : getChildren())
+		child->setTransform(juce::AffineTransform::scale(scale));
+
+	//DBG(
+	//	"WIDTH: " << WIDTH << " HEIGHT: " << HEIGHT << "\n"
+	//	<< " SMALL_SPACE: " << SMALL_SPACE << "\n"
+	//	<< " SMALL_TEXT_W: " << SMALL_TEXT_W << " SMALL_TEXT_H: " << SMALL_TEXT_H << "\n"
+	//	<< " SMALL_ROTARY_W: " << SMALL_ROTARY_W << " SMALL_ROTARY_H: " << SMALL_ROTARY_H << "\n"
+	//	<< "KNOB_SPACING: " << KNOB_SPACING
+	//);
+}
+
+void SulfuricAudioProcessorEditor::configureRotary(juce::Slider &slider)
+{
+	slider.setSliderStyle(juce::Slider::Rotary);
+	slider.setRotaryParameters(0, juce::MathConstants<float>::twoPi, true);
+	slider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, SMALL_TEXT_W, SMALL_TEXT_H);
+	slider.setColour(juce::Slider::textBoxOutlineColourId, metalGrey);
+	slider.setColour(juce::Slider::rotarySliderOutlineColourId, offWhite);
+	slider.setColour(juce::Slider::textBoxBackgroundColourId, brightMetalGrey);
+	slider.setColour(juce::Slider::textBoxTextColourId, offWhite);
+	slider.setColour(juce::Slider::rotarySliderOutlineColourId, metalGrey);
+	slider.setColour(juce::Slider::rotarySliderFillColourId, brightMetalGrey);
+	slider.setColour(juce::Slider::backgroundColourId, metalGrey);
+	slider.setColour(juce::Slider::thumbColourId, offWhite);
+	slider.setPopupDisplayEnabled(false, false, this);
+
+	// Redrawn from its cached image unless its value or hover state changes
+	slider.setBufferedToImage(true);
+}
+
+void SulfuricAudioProcessorEditor::configureButton(juce::ShapeButton& button, bool isToggle)
+{
+	button.setShape(getButtonShape(), true, true, false);
+	button.setClickingTogglesState(isToggle);
+	button.setColours(brightMetalGrey, brightMetalGrey, isToggle ? brightMetalGrey : offWhite);
+	button.setOnColours(offWhite, offWhite, offWhite);
+	button.shouldUseOnColours(true);
+	button.setBufferedToImage(true);
+}
+
+const juce::Path& SulfuricAudioProcessorEditor::getButtonShape()
+{
+	// Every button is the same circle, so it is built once for all of them
+	static const juce::Path shape = []
+	{
+		juce::Path circle;
+		circle.addEllipse(0, 0, SMALL_BUTTON, SMALL_BUTTON);
+		return circle;
+	}();
+
+	return shape;
+}
+
+uint64_t SulfuricAudioProcessorEditor::randomizeSeed()
+{
+	rng.setSeedRandomly();
+
+	// Display the seed as if it were unsigned
+	return (uint64_t)rng.getSeed();
+}
+
+void SulfuricAudioProcessorEditor::generatePatch()
+{
+	auto seed = randomizeSeed();
+	SulfuricPatchGenerator::apply(seed, audioProcessor);
+
+	std::ostringstream hexBuffer;
+	hexBuffer << std::hex << seed;
+	seedLabel.setText(juce::String(hexBuffer.str()), juce::NotificationType::dontSendNotification);
+}
+
+void SulfuricAudioProcessorEditor::openPresetBank(int presetToShow)
+{
+	presetThread.addJob([safeThis = juce::Component::SafePointer<SulfuricAudioProcessorEditor>(this), presetToShow]
+	{
+		auto bank = SulfuricPresetBank::open(SulfuricPresetBank::getDefaultFile());
+
+		juce::MessageManager::callAsync([safeThis, bank, presetToShow]
+		{
+			if (safeThis != nullptr)
+				safeThis->setPresetBank(bank, presetToShow);
+		});
+	});
+}
+
+void SulfuricAudioProcessorEditor::setPresetBank(std::shared_ptr<const SulfuricPresetBank> bank, int presetToShow)
+{
+	presetBank = std::move(bank);
+	currentPreset = presetBank != nullptr ? juce::jmin(currentPreset, presetBank->getNumPresets() - 1) : -1;
+
+	if (presetToShow >= 0 && presetButton.getToggleState())
+		showPreset(presetToShow);
+}
+
+void SulfuricAudioProcessorEditor::showPreset(int index)
+{
+	if (presetBank == nullptr || presetBank->getNumPresets() == 0)
+		return;
+
+	currentPreset = index % presetBank->getNumPresets();
+
+	// Already in memory, so this neither reads the disk nor parses any text
+	auto state = presetBank->getState(currentPreset);
+	audioProcessor.setStateInformation(state.data, state.size);
+
+	seedLabel.setText(presetBank->getName(currentPreset), juce::NotificationType::dontSendNotification);
+}
+
+void SulfuricAudioProcessorEditor::savePreset()
+{
+	SulfuricPresetBank::Preset preset;
+	preset.name = seedLabel.getText().isNotEmpty() ? seedLabel.getText() : juce::Time::getCurrentTime().formatted("%Y-%m-%d %H:%M:%S");
+	audioProcessor.getStateInformation(preset.state);
+
+	// Let go of the mapping first, some systems won't replace a file that is mapped
+	presetBank.reset();
+
+	presetThread.addJob([safeThis = juce::Component::SafePointer<SulfuricAudioProcessorEditor>(this), preset]
+	{
+		// Added to the bank on disk, not to this editor's copy, which may still be loading or predate another instance's save
+		auto newPreset = SulfuricPresetBank::append(SulfuricPresetBank::getDefaultFile(), preset);
+		auto bank = SulfuricPresetBank::open(SulfuricPresetBank::getDefaultFile());
+
+		juce::MessageManager::callAsync([safeThis, bank, newPreset]
+		{
+			if (safeThis != nullptr)
+			{
+				if (newPreset >= 0)
+					safeThis->currentPreset = newPreset;
+
+				safeThis->setPresetBank(bank, -1);
+			}
+		});
+	});
+}
+
+void SulfuricAudioProcessorEditor::timerCallback()
+{
+	auto snapshot = audioProcessor.getLoadMeter().getSnapshot();
+
+	// Leave the label empty until the host starts processing
+	if (snapshot.totalBlocks == 0)
+		return;
+
+	loadLabel.setText(
+		"CPU " + juce::String(snapshot.averageLoad * 100.0, 1) + "% (peak " + juce::String(snapshot.recentPeakLoad * 100.0, 1) + "%)"
+		+ "  VOICES " + juce::String(snapshot.activeVoices) + "/" + juce::String((int)*audioProcessor.polyphonyParam)
+		+ "  MEM " + juce::File::descriptionOfSizeInBytes((juce::int64)audioProcessor.getInstanceBytes())
+		+ (snapshot.governorTier > 0 ? "  ECO " + juce::String(snapshot.governorTier) : juce::String()),
+		juce::NotificationType::dontSendNotification);
 }
\ No newline at end of file
@@ -1,329 +1,589 @@
-/*
-  ==============================================================================
-
-	This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#include "PluginSynthesiser.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-SulfuricAudioProcessor::SulfuricAudioProcessor()
-#ifndef JucePlugin_PreferredChannelConfigurations
-	: AudioProcessor(BusesProperties().withOutput("Output", juce::AudioChannelSet::stereo(), true)),
-	params(*this, nullptr, juce::Identifier("SulfuricParams"),
-		{
-			std::make_unique<juce::AudioParameterFloat>("master", "Master", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.1f, "", Category::outputGain)
-		}
-	)
-#endif
-{
-	masterParam = params.getRawParameterValue("master");
-
-	synth = new juce::Synthesiser();
-	for (auto numVoices = 16; numVoices > 0; numVoices--) {
-		synth->addVoice(new SulfuricVoice());
-	}
-	synth->addSound(new SulfuricSound());
-}
-
-SulfuricAudioProcessor::~SulfuricAudioProcessor()
-{
-}
-
-//==============================================================================
-const juce::String SulfuricAudioProcessor::getName() const
-{
-	return JucePlugin_Name;
-}
-
-bool SulfuricAudioProcessor::acceptsMidi() const
-{
-#if JucePlugin_WantsMidiInput
-	return true;
-#else
-	return false;
-#endif
-}
-
-bool SulfuricAudioProcessor::producesMidi() const
-{
-#if JucePlugin_ProducesMidiOutput
-	return true;
-#else
-	return false;
-#endif
-}
-
-bool SulfuricAudioProcessor::isMidiEffect() const
-{
-#if JucePlugin_IsMidiEffect
-	return true;
-#else
-	return false;
-#endif
-}
-
-double SulfuricAudioProcessor::getTailLengthSeconds() const
-{
-	return 0.0;
-}
-
-int SulfuricAudioProcessor::getNumPrograms()
-{
-	return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-				// so this should be at least 1, even if you're not really implementing programs.
-}
-
-int SulfuricAudioProcessor::getCurrentProgram()
-{
-	return 0;
-}
-
-void SulfuricAudioProcessor::setCurrentProgram(int /*index*/)
-{
-}
-
-const juce::String SulfuricAudioProcessor::getProgramName(int /*index*/)
-{
-	return {};
-}
-
-void SulfuricAudioProcessor::changeProgramName(int /*index*/, const juce::String& /*newName*/)
-{
-}
-
-//==============================================================================
-void SulfuricAudioProcessor::prepareToPlay(double sampleRate, int /*samplesPerBlock*/)
-{
-	// Use this method as the place to do any pre-playback
-	// initialisation that you need..
-	synth->setCurrentPlaybackSampleRate(sampleRate);
-	prevMaster = *masterParam;
-}
-
-void SulfuricAudioProcessor::releaseResources()
-{
-	// When playback stops, you can use this as an opportunity to free up any
-	// spare memory, etc.
-}
-
-#ifndef JucePlugin_PreferredChannelConfigurations
-bool SulfuricAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
-{
-#if JucePlugin_IsMidiEffect
-	juce::ignoreUnused(layouts);
-	return true;
-#else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-		return false;
-
-	// This checks if the input layout matches the output layout
-#if ! JucePlugin_IsSynth
-	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-		return false;
-#endif
-
-	return true;
-#endif
-}
-#endif
-
-juce::MidiBuffer SulfuricAudioProcessor::filterMidiMessagesForChannel(const juce::MidiBuffer& input, int channel)
-{
-	juce::MidiBuffer output;
-
-	for (auto metadata : input)
-	{
-		auto message = metadata.getMessage();
-
-		if (message.getChannel() == channel)
-			output.addEvent(message, metadata.samplePosition);
-	}
-
-	return output;
-}
-
-void SulfuricAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
-{
-	auto busCount = getBusCount(false);
-	for (auto busNr = 0; busNr < busCount; ++busNr)
-	{
-		auto audioBusBuffer = getBusBuffer(buffer, false, busNr);
-		auto midiChannelBuffer = filterMidiMessagesForChannel(midiMessages, busNr + 1);
-		synth->renderNextBlock(audioBusBuffer, midiChannelBuffer, 0, audioBusBuffer.getNumSamples());
-	}
-
-	// Set master level last
-	float currentMaster = *masterParam;
-	if (currentMaster == prevMaster)
-	{
-		buffer.applyGain(currentMaster);
-	}
-	else
-	{
-		buffer.applyGainRamp(0, buffer.getNumSamples(), prevMaster, currentMaster);
-		prevMaster = currentMaster;
-	}
-}
-
-//==============================================================================
-bool SulfuricAudioProcessor::hasEditor() const
-{
-	return true; // (change this to false if you choose to not supply an editor)
-}
-
-juce::AudioProcessorEditor* SulfuricAudioProcessor::createEditor()
-{
-	return new SulfuricAudioProcessorEditor(*this, params);
-}
-
-//==============================================================================
-void SulfuricAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
-{
-	// You should use this method to store your parameters in the memory block.
-	// You could do that either as raw data, or use the XML or ValueTree classes
-	// as intermediaries to make it easy to save and load complex data.
-	auto state = params.copyState();
-	std::unique_ptr<juce::XmlElement> xml(state.createXml());
-	copyXmlToBinary(*xml, destData);
-}
-
-void SulfuricAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
-{
-	// You should use this method to restore your parameters from this memory block,
-	// whose contents will have been created by the getStateInformation() call.
-	std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-
-	if (xmlState.get() != nullptr)
-		if (xmlState->hasTagName(params.state.getType()))
-			params.replaceState(juce::ValueTree::fromXml(*xmlState));
-}
-
-bool SulfuricSound::appliesToNote(int /*note*/)
-{
-	return true;
-}
-
-bool SulfuricSound::appliesToChannel(int /*channel*/)
-{
-	return true;
-}
-
-bool SulfuricVoice::canPlaySound(juce::SynthesiserSound* sound)
-{
-	return dynamic_cast<SulfuricSound*> (sound) != nullptr;
-}
-
-void SulfuricVoice::updateAngleDelta()
-{
-	auto cyclesPerSample = currentFrequency / getSampleRate();
-	angleDelta = cyclesPerSample * 2.0 * juce::MathConstants<double>::pi;          // [3]
-}
-
-
-void SulfuricVoice::startNote(int midiNoteNumber, float velocity,
-	juce::SynthesiserSound*, int /*currentPitchWheelPosition*/)
-{
-	currentAngle = 0.0;
-	level = velocity;
-	tailOff = 0.0;
-
-	if (rampOn == 0.0) {
-		rampOn = 1.0;
-	}
-
-	currentFrequency = juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber);
-	updateAngleDelta();
-}
-
-void SulfuricVoice::stopNote(float /*velocity*/, bool allowTailOff)
-{
-	rampOn = 0.0;
-
-	if (allowTailOff)
-	{
-		if (tailOff == 0.0)
-			tailOff = 1.0;
-	}
-	else
-	{
-		clearCurrentNote();
-		angleDelta = 0.0;
-	}
-}
-
-void SulfuricVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
-{
-	if (angleDelta != 0.0)
-	{
-		if (tailOff > 0.0)
-		{
-			while (--numSamples >= 0)
-			{
-				auto currentSample = (float)(std::sin(currentAngle) * level * tailOff);
-
-				for (auto i = outputBuffer.getNumChannels(); --i >= 0;)
-					outputBuffer.addSample(i, startSample, currentSample);
-
-				currentAngle += angleDelta;
-				++startSample;
-
-				tailOff *= 0.99;
-
-				if (tailOff <= 0.005)
-				{
-					clearCurrentNote();
-
-					angleDelta = 0.0;
-					break;
-				}
-			}
-		}
-		else if (rampOn > 0.0) 
-		{
-			while (--numSamples >= 0)
-			{
-				auto currentSample = (float)(std::sin(currentAngle) * level * (1 - rampOn));
-
-				for (auto i = outputBuffer.getNumChannels(); --i >= 0;)
-					outputBuffer.addSample(i, startSample, currentSample);
-
-				currentAngle += angleDelta;
-				++startSample;
-
-				rampOn *= 0.99;
-
-				if (rampOn <= 0.005)
-				{
-					rampOn = 0.0;
-				}
-			}
-		}
-		else
-		{
-			while (--numSamples >= 0)
-			{
-				auto currentSample = (float)(std::sin(currentAngle) * level);
-
-				for (auto i = outputBuffer.getNumChannels(); --i >= 0;)
-					outputBuffer.addSample(i, startSample, currentSample);
-
-				currentAngle += angleDelta;
-				++startSample;
-			}
-		}
-	}
-}
-
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
-{
-	return new SulfuricAudioProcessor();
+/*
+  ==============================================================================
+
+	This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#include "PluginSynthesiser.h"
+#include "PluginEditor.h"
+#include "RealtimeAudit.h"
+#include "StateFormat.h"
+#include "TableCache.h"
+
+//==============================================================================
+namespace
+{
+	juce::AudioProcessor::BusesProperties createBusesProperties()
+	{
+		auto buses = juce::AudioProcessor::BusesProperties().withOutput("Output", juce::AudioChannelSet::stereo(), true);
+
+		// Hosts enable the rest for multi-out, one per MIDI channel
+		for (auto bus = 2; bus <= SulfuricAudioProcessor::MAX_OUTPUT_BUSES; ++bus)
+			buses = buses.withOutput("Output " + juce::String(bus), juce::AudioChannelSet::stereo(), false);
+
+		return buses;
+	}
+
+	// Ramps are interleaved with the rest of their SIMD group, so this walks one with a stride rather than vectorising
+	template <typename SampleType>
+	void multiplyByRamp(juce::AudioBuffer<SampleType>& buffer, SulfuricParameterEngine::Ramp ramp, int numSamples) noexcept
+	{
+		for (auto channel = 0; channel < buffer.getNumChannels(); ++channel)
+		{
+			auto* samples = buffer.getWritePointer(channel);
+			for (auto i = 0; i < numSamples; ++i)
+				samples[i] *= ramp[i];
+		}
+	}
+}
+
+//==============================================================================
+SulfuricAudioProcessor::SulfuricAudioProcessor()
+#ifndef JucePlugin_PreferredChannelConfigurations
+	: AudioProcessor(createBusesProperties()),
+	params(*this, nullptr, juce::Identifier("SulfuricParams"),
+		{
+			std::make_unique<juce::AudioParameterFloat>("master", "Master", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.1f, "", Category::outputGain),
+			// Order matches OscillatorQuality
+			std::make_unique<juce::AudioParameterChoice>("quality", "Quality", juce::StringArray{ "Exact", "Phasor", "Cubic", "Linear" }, (int)OscillatorQuality::cubic),
+			std::make_unique<juce::AudioParameterInt>("polyphony", "Polyphony", 1, MAX_POLYPHONY, DEFAULT_POLYPHONY),
+			std::make_unique<juce::AudioParameterFloat>("attack", "Attack", juce::NormalisableRange<float>(0.0f, 10.0f, 0.001f, 0.3f), SulfuricEnvelope::Parameters().attackSeconds, "s"),
+			std::make_unique<juce::AudioParameterFloat>("decay", "Decay", juce::NormalisableRange<float>(0.0f, 10.0f, 0.001f, 0.3f), SulfuricEnvelope::Parameters().decaySeconds, "s"),
+			std::make_unique<juce::AudioParameterFloat>("sustain", "Sustain", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), SulfuricEnvelope::Parameters().sustainLevel),
+			std::make_unique<juce::AudioParameterFloat>("release", "Release", juce::NormalisableRange<float>(0.0f, 10.0f, 0.001f, 0.3f), SulfuricEnvelope::Parameters().releaseSeconds, "s"),
+			std::make_unique<juce::AudioParameterBool>("multicore", "Multi-core Voices", true),
+			std::make_unique<juce::AudioParameterInt>("tune", "Tune", -24, 24, 0, "st"),
+			std::make_unique<juce::AudioParameterFloat>("fine", "Fine", juce::NormalisableRange<float>(-100.0f, 100.0f, 0.1f), 0.0f, "ct"),
+			std::make_unique<juce::AudioParameterFloat>("velocity", "Velocity", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 1.0f),
+			// Order matches SulfuricFilter::Mode
+			std::make_unique<juce::AudioParameterChoice>("filter", "Filter", juce::StringArray{ "Off", "Low Pass", "Band Pass", "High Pass" }, (int)SulfuricFilter::Mode::off),
+			std::make_unique<juce::AudioParameterFloat>("cutoff", "Cutoff", juce::NormalisableRange<float>(SulfuricFilter::MIN_HZ, 20000.0f, 0.1f, 0.25f), SulfuricFilter::Parameters().cutoffHz, "Hz"),
+			std::make_unique<juce::AudioParameterFloat>("resonance", "Resonance", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), SulfuricFilter::Parameters().resonance),
+			std::make_unique<juce::AudioParameterFloat>("filterenv", "Filter Env", juce::NormalisableRange<float>(-8.0f, 8.0f, 0.01f), SulfuricFilter::Parameters().envelopeOctaves, "oct"),
+			std::make_unique<juce::AudioParameterInt>("unison", "Unison", 1, SulfuricVoiceBank::MAX_UNISON, SulfuricVoiceBank::Unison().voices),
+			std::make_unique<juce::AudioParameterFloat>("detune", "Detune", juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), SulfuricVoiceBank::Unison().detuneCents, "ct"),
+			std::make_unique<juce::AudioParameterFloat>("spread", "Spread", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), SulfuricVoiceBank::Unison().spread)
+		}
+	)
+#endif
+{
+	masterParam = params.getRawParameterValue("master");
+	qualityParam = params.getRawParameterValue("quality");
+	polyphonyParam = params.getRawParameterValue("polyphony");
+	attackParam = params.getRawParameterValue("attack");
+	decayParam = params.getRawParameterValue("decay");
+	sustainParam = params.getRawParameterValue("sustain");
+	releaseParam = params.getRawParameterValue("release");
+	multicoreParam = params.getRawParameterValue("multicore");
+	tuneParam = params.getRawParameterValue("tune");
+	fineParam = params.getRawParameterValue("fine");
+	velocityParam = params.getRawParameterValue("velocity");
+	filterParam = params.getRawParameterValue("filter");
+	cutoffParam = params.getRawParameterValue("cutoff");
+	resonanceParam = params.getRawParameterValue("resonance");
+	filterEnvelopeParam = params.getRawParameterValue("filterenv");
+	unisonParam = params.getRawParameterValue("unison");
+	detuneParam = params.getRawParameterValue("detune");
+	spreadParam = params.getRawParameterValue("spread");
+
+	for (auto* id : PATCH_PARAMETER_IDS)
+		patchParameters.add(params.getParameter(id));
+
+	using Smoothing = SulfuricParameterEngine::Smoothing;
+	parameterEngine.add(masterParam, Smoothing::linear, GAIN_SMOOTHING_SECONDS);
+	parameterEngine.add(qualityParam);
+	parameterEngine.add(polyphonyParam);
+	parameterEngine.add(attackParam);
+	parameterEngine.add(decayParam);
+	// Unsmoothed, since setEnvelope() touches every sustaining voice whenever it changes and a ramp would cost that every block
+	parameterEngine.add(sustainParam);
+	parameterEngine.add(releaseParam);
+	parameterEngine.add(multicoreParam);
+	parameterEngine.add(tuneParam);
+	parameterEngine.add(fineParam);
+	parameterEngine.add(velocityParam);
+	parameterEngine.add(filterParam);
+	parameterEngine.add(cutoffParam);
+	parameterEngine.add(resonanceParam);
+	parameterEngine.add(filterEnvelopeParam);
+	parameterEngine.add(unisonParam);
+	parameterEngine.add(detuneParam);
+	parameterEngine.add(spreadParam);
+	jassert(parameterEngine.getNumParameters() == SPREAD + 1);
+
+	// Usable before prepareToPlay, prepareToPlay sizes it properly
+	parameterEngine.prepare(44100.0, 0);
+
+	currentQuality = (OscillatorQuality)(int)*qualityParam;
+	currentEnvelope = getEnvelopeParameters();
+	currentFilter = getFilterParameters();
+	currentUnison = getUnisonParameters();
+
+	// No voice engine yet, prepareToPlay creates them for the buses the host actually enabled
+	measureMemory();
+}
+
+SulfuricAudioProcessor::~SulfuricAudioProcessor()
+{
+}
+
+//==============================================================================
+const juce::String SulfuricAudioProcessor::getName() const
+{
+	return JucePlugin_Name;
+}
+
+bool SulfuricAudioProcessor::acceptsMidi() const
+{
+#if JucePlugin_WantsMidiInput
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool SulfuricAudioProcessor::producesMidi() const
+{
+#if JucePlugin_ProducesMidiOutput
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool SulfuricAudioProcessor::isMidiEffect() const
+{
+#if JucePlugin_IsMidiEffect
+	return true;
+#else
+	return false;
+#endif
+}
+
+double SulfuricAudioProcessor::getTailLengthSeconds() const
+{
+	return *releaseParam;
+}
+
+int SulfuricAudioProcessor::getNumPrograms()
+{
+	return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+				// so this should be at least 1, even if you're not really implementing programs.
+}
+
+int SulfuricAudioProcessor::getCurrentProgram()
+{
+	return 0;
+}
+
+void SulfuricAudioProcessor::setCurrentProgram(int /*index*/)
+{
+}
+
+const juce::String SulfuricAudioProcessor::getProgramName(int /*index*/)
+{
+	return {};
+}
+
+void SulfuricAudioProcessor::changeProgramName(int /*index*/, const juce::String& /*newName*/)
+{
+}
+
+//==============================================================================
+void SulfuricAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
+{
+	// Use this method as the place to do any pre-playback
+	// initialisation that you need..
+	auto busCount = getBusCount(false);
+
+	// A disabled bus gets an engine once the host enables it and prepares again, and keeps it from then on
+	synths.resize((size_t)juce::jmax(busCount, (int)synths.size()));
+	for (auto busNr = 0; busNr < busCount; ++busNr)
+		if (synths[(size_t)busNr] == nullptr && getBus(false, busNr)->isEnabled())
+			synths[(size_t)busNr] = createVoiceEngine();
+
+	forEachSynth([sampleRate](SulfuricVoiceEngine& synth) { synth.setCurrentPlaybackSampleRate(sampleRate); });
+
+	// The threads start here, never on the audio thread, and every instance shares them. They sleep unless there are several buses or a lot of voices to render.
+	if (!usesWorkerThreads)
+		workerPool.reset();
+	else if (workerPool == nullptr)
+		workerPool = SulfuricWorkerPool::getShared(SulfuricWorkerPool::getDefaultNumWorkers(MAX_WORKERS));
+
+	forEachSynth([this](SulfuricVoiceEngine& synth) { synth.setWorkerPool(workerPool.get()); });
+
+	midiRouter.prepare(busCount, MAX_MIDI_EVENTS_PER_BLOCK);
+	loadMeter.prepare(sampleRate);
+	scopeFeed.prepare(sampleRate);
+	governor.prepare(sampleRate);
+	parameterEngine.prepare(sampleRate, samplesPerBlock);
+
+	measureMemory();
+}
+
+void SulfuricAudioProcessor::releaseResources()
+{
+	// When playback stops, you can use this as an opportunity to free up any
+	// spare memory, etc.
+}
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+bool SulfuricAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
+{
+#if JucePlugin_IsMidiEffect
+	juce::ignoreUnused(layouts);
+	return true;
+#else
+	// This is the place where you check if the layout is supported.
+	// In this template code we only support mono or stereo.
+	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
+		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+		return false;
+
+	// The multi-out buses can be switched off too
+	for (const auto& bus : layouts.outputBuses)
+		if (!bus.isDisabled() && bus != juce::AudioChannelSet::mono() && bus != juce::AudioChannelSet::stereo())
+			return false;
+
+	// This checks if the input layout matches the output layout
+#if ! JucePlugin_IsSynth
+	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+		return false;
+#endif
+
+	return true;
+#endif
+}
+#endif
+
+void SulfuricAudioProcessor::setOscillatorQuality(OscillatorQuality quality)
+{
+	forEachSynth([quality](SulfuricVoiceEngine& synth) { synth.setQuality(quality); });
+}
+
+std::unique_ptr<SulfuricVoiceEngine> SulfuricAudioProcessor::createVoiceEngine() const
+{
+	auto synth = std::make_unique<SulfuricVoiceEngine>(MAX_POLYPHONY);
+	synth->setQuality(currentQuality);
+	synth->setEnvelope(currentEnvelope);
+	synth->setFilter(currentFilter);
+	synth->setUnison(currentUnison);
+	synth->setPolyphony((int)*polyphonyParam);
+	synth->setTuning(*tuneParam + *fineParam / 100.0f);
+	synth->setVelocitySensitivity(*velocityParam);
+	return synth;
+}
+
+int SulfuricAudioProcessor::getNumActiveVoices() const noexcept
+{
+	auto numActive = 0;
+	forEachSynth([&numActive](const SulfuricVoiceEngine& synth) { numActive += synth.getNumActiveVoices(); });
+	return numActive;
+}
+
+SulfuricAudioProcessor::MemoryFootprint SulfuricAudioProcessor::getMemoryFootprint() const
+{
+	MemoryFootprint footprint;
+	footprint.instanceBytes = getInstanceBytes();
+	footprint.workerThreads = numWorkerThreads.load(std::memory_order_relaxed);
+
+	auto tables = SulfuricTableCache::getStatistics();
+	footprint.sharedBytes = tables.bytes;
+	footprint.sharedTables = tables.numTables;
+	return footprint;
+}
+
+void SulfuricAudioProcessor::measureMemory() noexcept
+{
+	auto bytes = sizeof(*this) + midiRouter.getMemoryUsage() - sizeof(midiRouter)
+		+ parameterEngine.getMemoryUsage() - sizeof(parameterEngine);
+
+	forEachSynth([&bytes](const SulfuricVoiceEngine& synth) { bytes += synth.getMemoryUsage(); });
+
+	instanceBytes.store(bytes, std::memory_order_relaxed);
+	numWorkerThreads.store(workerPool != nullptr ? workerPool->getNumWorkers() : 0, std::memory_order_relaxed);
+}
+
+SulfuricEnvelope::Parameters SulfuricAudioProcessor::getEnvelopeParameters() const noexcept
+{
+	SulfuricEnvelope::Parameters parameters;
+	parameters.attackSeconds = *attackParam;
+	parameters.decaySeconds = *decayParam;
+	parameters.sustainLevel = *sustainParam;
+	parameters.releaseSeconds = *releaseParam;
+	return parameters;
+}
+
+SulfuricFilter::Parameters SulfuricAudioProcessor::getFilterParameters() const noexcept
+{
+	SulfuricFilter::Parameters parameters;
+	parameters.mode = (SulfuricFilter::Mode)(int)*filterParam;
+	parameters.cutoffHz = *cutoffParam;
+	parameters.resonance = *resonanceParam;
+	parameters.envelopeOctaves = *filterEnvelopeParam;
+	return parameters;
+}
+
+SulfuricVoiceBank::Unison SulfuricAudioProcessor::getUnisonParameters() const noexcept
+{
+	SulfuricVoiceBank::Unison parameters;
+	parameters.voices = (int)*unisonParam;
+	parameters.detuneCents = *detuneParam;
+	parameters.spread = *spreadParam;
+	return parameters;
+}
+
+bool SulfuricAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+	return true;
+}
+
+void SulfuricAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+	process(buffer, midiMessages);
+}
+
+void SulfuricAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+	process(buffer, midiMessages);
+}
+
+template <typename SampleType>
+void SulfuricAudioProcessor::process(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages)
+{
+	SULFURIC_REALTIME_SCOPE();
+	auto blockStart = juce::Time::getHighResolutionTicks();
+
+	parameterEngine.process(buffer.getNumSamples());
+	auto value = [this](ParameterIndex index) noexcept { return parameterEngine.getValue(index); };
+
+	// Decided at the end of the previous block
+	using Tier = SulfuricCpuGovernor::Tier;
+	auto tier = isNonRealtime() ? Tier::full : governor.getTier();
+
+	auto quality = (OscillatorQuality)(int)value(QUALITY);
+	if (tier >= Tier::cheapOscillators && (quality == OscillatorQuality::exact || quality == OscillatorQuality::cubic))
+		quality = OscillatorQuality::linear;
+
+	if (quality != currentQuality)
+	{
+		currentQuality = quality;
+		setOscillatorQuality(quality);
+	}
+
+	auto polyphony = (int)value(POLYPHONY);
+	auto shedVoices = tier >= Tier::shedVoices;
+	if (shedVoices)
+		polyphony = juce::jmax(1, polyphony / 2);
+
+	// Once on the way into the tier, and again only if polyphony drops while in it. The lower polyphony keeps new notes in check.
+	auto releaseVoicesOverPolyphony = shedVoices && (shedPolyphony == 0 || polyphony < shedPolyphony);
+	shedPolyphony = shedVoices ? polyphony : 0;
+
+	auto controlInterval = tier >= Tier::coarseControl ? COARSE_CONTROL_INTERVAL : SulfuricVoiceEngine::DEFAULT_CONTROL_INTERVAL;
+	auto tuning = value(TUNE) + value(FINE) / 100.0f;
+	auto velocitySensitivity = value(VELOCITY);
+	forEachSynth([&](SulfuricVoiceEngine& synth)
+	{
+		synth.setPolyphony(polyphony);
+		synth.setControlInterval(controlInterval);
+		synth.setTuning(tuning);
+		synth.setVelocitySensitivity(velocitySensitivity);
+
+		if (releaseVoicesOverPolyphony)
+			synth.releaseQuietestVoices(polyphony);
+	});
+
+	// Segment coefficients only get recomputed when a time actually changes
+	SulfuricEnvelope::Parameters envelope;
+	envelope.attackSeconds = value(ATTACK);
+	envelope.decaySeconds = value(DECAY);
+	envelope.sustainLevel = value(SUSTAIN);
+	envelope.releaseSeconds = value(RELEASE);
+
+	if (envelope != currentEnvelope)
+	{
+		currentEnvelope = envelope;
+		forEachSynth([&envelope](SulfuricVoiceEngine& synth) { synth.setEnvelope(envelope); });
+	}
+
+	// Only copied into the banks, each voice's coefficients follow at control rate
+	SulfuricFilter::Parameters filter;
+	filter.mode = (SulfuricFilter::Mode)(int)value(FILTER);
+	filter.cutoffHz = value(CUTOFF);
+	filter.resonance = value(RESONANCE);
+	filter.envelopeOctaves = value(FILTER_ENVELOPE);
+
+	if (filter != currentFilter)
+	{
+		currentFilter = filter;
+		forEachSynth([&filter](SulfuricVoiceEngine& synth) { synth.setFilter(filter); });
+	}
+
+	// Retunes the copies of every sounding voice, so it is only worth doing when something moved
+	SulfuricVoiceBank::Unison unison;
+	unison.voices = (int)value(UNISON);
+	unison.detuneCents = value(DETUNE);
+	unison.spread = value(SPREAD);
+
+	if (unison != currentUnison)
+	{
+		currentUnison = unison;
+		forEachSynth([&unison](SulfuricVoiceEngine& synth) { synth.setUnison(unison); });
+	}
+
+	auto master = value(MASTER);
+	auto isMasterSmoothing = parameterEngine.isSmoothing(MASTER);
+	auto masterRampLength = juce::jmin(buffer.getNumSamples(), parameterEngine.getMaxBlockSize());
+
+	juce::int64 gainTicks = 0;
+
+	// Idle: no voice sounding and nothing that could start one, so there is nothing to render or scale
+	if (getNumActiveVoices() == 0 && midiMessages.isEmpty())
+	{
+		// Also sets the buffer's clear flag, which is how JUCE passes silence on to the host
+		buffer.clear();
+	}
+	else
+	{
+		auto busCount = juce::jmin(getBusCount(false), (int)synths.size());
+		auto isRouted = busCount <= midiRouter.getNumBuses() && midiRouter.route(midiMessages);
+		auto numBusyBuses = 0;
+
+		// Only buses that are enabled and have voices or MIDI to play need a job
+		for (auto busNr = 0; busNr < busCount; ++busNr)
+		{
+			busResults[(size_t)busNr] = {};
+
+			if (!getBus(false, busNr)->isEnabled() || synths[(size_t)busNr] == nullptr)
+				continue;
+
+			if (synths[(size_t)busNr]->getNumActiveVoices() > 0 || !isRouted || !midiRouter.getEventsForBus(busNr).isEmpty())
+				busyBuses[(size_t)numBusyBuses++] = busNr;
+		}
+
+		// With more than one bus busy the pool is taken, so their voices stay on whichever thread renders the bus
+		auto parallelVoices = numBusyBuses == 1 && value(MULTICORE) >= 0.5f;
+		for (auto job = 0; job < numBusyBuses; ++job)
+			synths[(size_t)busyBuses[(size_t)job]]->setParallelRendering(parallelVoices);
+
+		auto renderBus = [&](int job, int) noexcept
+		{
+			SULFURIC_REALTIME_SCOPE();
+
+			auto busNr = busyBuses[(size_t)job];
+			auto& result = busResults[(size_t)busNr];
+			auto& synth = *synths[(size_t)busNr];
+			auto audioBusBuffer = getBusBuffer(buffer, false, busNr);
+
+			if (isRouted)
+				result.isAudible = synth.renderNextBlock(audioBusBuffer, midiRouter.getEventsForBus(busNr), 0, audioBusBuffer.getNumSamples());
+			else // More events than the router has room for, scan the host's buffer once per bus instead
+				result.isAudible = synth.renderNextBlock(audioBusBuffer, midiMessages, 0, audioBusBuffer.getNumSamples(), busNr + 1);
+
+			if (!result.isAudible)
+				return;
+
+			// Set master level last
+			auto gainStart = juce::Time::getHighResolutionTicks();
+
+			if (isMasterSmoothing)
+			{
+				multiplyByRamp(audioBusBuffer, parameterEngine.getRamp(MASTER), masterRampLength);
+
+				// Only when the host sends a bigger block than it promised
+				if (masterRampLength < audioBusBuffer.getNumSamples())
+					audioBusBuffer.applyGain(masterRampLength, audioBusBuffer.getNumSamples() - masterRampLength, (SampleType)master);
+			}
+			else
+				audioBusBuffer.applyGain((SampleType)master);
+
+			result.gainTicks = juce::Time::getHighResolutionTicks() - gainStart;
+		};
+
+		if (workerPool != nullptr)
+			workerPool->run(numBusyBuses, renderBus);
+		else
+			for (auto job = 0; job < numBusyBuses; ++job)
+				renderBus(job, 0);
+
+		// No voice rendered into these buses, so they are known to be silent and need no master gain
+		auto silentBuses = 0;
+
+		for (auto busNr = 0; busNr < busCount; ++busNr)
+		{
+			auto& result = busResults[(size_t)busNr];
+			gainTicks += result.gainTicks;
+
+			if (!result.isAudible)
+			{
+				getBusBuffer(buffer, false, busNr).clear();
+				++silentBuses;
+			}
+		}
+
+		if (silentBuses == busCount)
+			buffer.clear();
+	}
+
+	// Just an atomic load while the editor is closed
+	scopeFeed.push(getBusBuffer(buffer, false, 0));
+
+	auto blockTicks = juce::Time::getHighResolutionTicks() - blockStart;
+
+	SulfuricLoadMeter::BlockTiming timing;
+	timing.numSamples = buffer.getNumSamples();
+	timing.activeVoices = getNumActiveVoices();
+	timing.renderSeconds = juce::Time::highResolutionTicksToSeconds(blockTicks - gainTicks);
+	timing.gainSeconds = juce::Time::highResolutionTicksToSeconds(gainTicks);
+	timing.blockSeconds = juce::Time::highResolutionTicksToSeconds(blockTicks);
+	timing.governorTier = (int)tier;
+	loadMeter.push(timing);
+
+	if (!isNonRealtime())
+		governor.update(timing.numSamples, timing.blockSeconds);
+}
+
+//==============================================================================
+bool SulfuricAudioProcessor::hasEditor() const
+{
+	return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor* SulfuricAudioProcessor::createEditor()
+{
+	return new SulfuricAudioProcessorEditor(*this, params);
+}
+
+//==============================================================================
+void SulfuricAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
+{
+	// You should use this method to store your parameters in the memory block.
+	// You could do that either as raw data, or use the XML or ValueTree classes
+	// as intermediaries to make it easy to save and load complex data.
+	SulfuricStateFormat::write(getParameters(), destData);
+}
+
+void SulfuricAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
+{
+	// You should use this method to restore your parameters from this memory block,
+	// whose contents will have been created by the getStateInformation() call.
+	if (SulfuricStateFormat::read(getParameters(), data, sizeInBytes))
+		return;
+
+	// Sessions and presets saved before the binary format
+	std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
+
+	if (xmlState.get() != nullptr)
+		if (xmlState->hasTagName(params.state.getType()))
+			params.replaceState(juce::ValueTree::fromXml(*xmlState));
+}
+
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+	return new SulfuricAudioProcessor();
 }
\ No newline at end of file
@@ -1,98 +1,212 @@
-/*
-  ==============================================================================
-
-	This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <juce_audio_processors/juce_audio_processors.h>
-
-//==============================================================================
-/**
-*/
-class SulfuricAudioProcessor : public juce::AudioProcessor
-{
-public:
-	//==============================================================================
-	SulfuricAudioProcessor();
-	~SulfuricAudioProcessor() override;
-
-	typedef juce::AudioProcessorParameter::Category Category;
-
-	//==============================================================================
-	void prepareToPlay(double, int) override;
-	void releaseResources() override;
-
-#ifndef JucePlugin_PreferredChannelConfigurations
-	bool isBusesLayoutSupported(const BusesLayout&) const override;
-#endif
-
-	void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-
-	//==============================================================================
-	juce::AudioProcessorEditor* createEditor() override;
-	bool hasEditor() const override;
-
-	//==============================================================================
-	const juce::String getName() const override;
-
-	bool acceptsMidi() const override;
-	bool producesMidi() const override;
-	bool isMidiEffect() const override;
-	double getTailLengthSeconds() const override;
-
-	//==============================================================================
-	int getNumPrograms() override;
-	int getCurrentProgram() override;
-	void setCurrentProgram(int) override;
-	const juce::String getProgramName(int) override;
-	void changeProgramName(int, const juce::String&) override;
-
-	//==============================================================================
-	void getStateInformation(juce::MemoryBlock&) override;
-	void setStateInformation(const void*, int) override;
-
-	//==============================================================================
-	std::atomic<float>* masterParam;
-	float prevMaster;
-
-private:
-	juce::Synthesiser* synth;
-
-	juce::AudioProcessorValueTreeState params;
-	//==============================================================================
-	static juce::MidiBuffer filterMidiMessagesForChannel(const juce::MidiBuffer&, int);
-
-	//==============================================================================
-	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SulfuricAudioProcessor)
-};
-
-//==============================================================================
-struct SulfuricSound : public juce::SynthesiserSound
-{
-    SulfuricSound() {}
-
-	bool appliesToNote(int) override;
-	bool appliesToChannel(int) override;
-};
-
-//==============================================================================
-struct SulfuricVoice : public juce::SynthesiserVoice
-{
-    SulfuricVoice() {}
-
-    bool canPlaySound(juce::SynthesiserSound*) override;
-	void startNote(int, float, juce::SynthesiserSound*, int) override;
-	void stopNote(float, bool) override;
-    void pitchWheelMoved(int) override {}
-    void controllerMoved(int, int) override {}
-	void renderNextBlock(juce::AudioBuffer<float>&, int, int) override;
-
-private:
-	void updateAngleDelta();
-    double currentAngle = 0.0, angleDelta = 0.0, level = 0.0, tailOff = 0.0, rampOn = 0.0;
-	double currentFrequency = 0.0, targetFrequency = 0.0;
+/*
+  ==============================================================================
+
+	This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "CpuGovernor.h"
+#include "LoadMeter.h"
+#include "ParameterEngine.h"
+#include "ScopeFeed.h"
+#include "VoiceEngine.h"
+#include "WorkerPool.h"
+
+//==============================================================================
+/**
+*/
+class SulfuricAudioProcessor : public juce::AudioProcessor
+{
+public:
+	//==============================================================================
+	SulfuricAudioProcessor();
+	~SulfuricAudioProcessor() override;
+
+	typedef juce::AudioProcessorParameter::Category Category;
+
+	//==============================================================================
+	void prepareToPlay(double, int) override;
+	void releaseResources() override;
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+	bool isBusesLayoutSupported(const BusesLayout&) const override;
+#endif
+
+	void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+	void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+	bool supportsDoublePrecisionProcessing() const override;
+
+	//==============================================================================
+	juce::AudioProcessorEditor* createEditor() override;
+	bool hasEditor() const override;
+
+	//==============================================================================
+	const juce::String getName() const override;
+
+	bool acceptsMidi() const override;
+	bool producesMidi() const override;
+	bool isMidiEffect() const override;
+	double getTailLengthSeconds() const override;
+
+	//==============================================================================
+	int getNumPrograms() override;
+	int getCurrentProgram() override;
+	void setCurrentProgram(int) override;
+	const juce::String getProgramName(int) override;
+	void changeProgramName(int, const juce::String&) override;
+
+	//==============================================================================
+	void getStateInformation(juce::MemoryBlock&) override;
+	void setStateInformation(const void*, int) override;
+
+	//==============================================================================
+	std::atomic<float>* masterParam;
+	std::atomic<float>* qualityParam;
+	std::atomic<float>* polyphonyParam;
+	std::atomic<float>* attackParam;
+	std::atomic<float>* decayParam;
+	std::atomic<float>* sustainParam;
+	std::atomic<float>* releaseParam;
+	std::atomic<float>* multicoreParam;
+	std::atomic<float>* tuneParam;
+	std::atomic<float>* fineParam;
+	std::atomic<float>* velocityParam;
+	std::atomic<float>* filterParam;
+	std::atomic<float>* cutoffParam;
+	std::atomic<float>* resonanceParam;
+	std::atomic<float>* filterEnvelopeParam;
+	std::atomic<float>* unisonParam;
+	std::atomic<float>* detuneParam;
+	std::atomic<float>* spreadParam;
+
+	// Every voice of an enabled bus is allocated in prepareToPlay, the polyphony parameter only limits how many sound at once
+	const static int DEFAULT_POLYPHONY = 16;
+	const static int MAX_POLYPHONY = 256;
+
+	// Output n + 1 plays MIDI channel n + 1 on its own voice engine. Only the first is enabled by default.
+	const static int MAX_OUTPUT_BUSES = 16;
+
+	/** Summed over every bus. */
+	int getNumActiveVoices() const noexcept;
+
+	/** What makes up a patch, in the order of the editor's knobs. SulfuricPatchGenerator sets these and nothing else. */
+	const juce::Array<juce::RangedAudioParameter*>& getPatchParameters() const noexcept { return patchParameters; }
+
+	/**
+		Lets prepareToPlay hand buses and voices to the shared worker threads, on by default.
+		Turn it off where something else already keeps every core busy, like a batch of offline renders.
+	*/
+	void setUsesWorkerThreads(bool shouldUse) noexcept { usesWorkerThreads = shouldUse; }
+
+	/** Per-block timings, voice counts and the CPU governor's tier, for the editor's meter or anything else monitoring the plugin. */
+	const SulfuricLoadMeter& getLoadMeter() const noexcept { return loadMeter; }
+
+	/** The main output, decimated, for the editor's scope and spectrum. Only fed while something views it. */
+	SulfuricScopeFeed& getScopeFeed() noexcept { return scopeFeed; }
+
+	struct MemoryFootprint
+	{
+		// Everything this instance allocated itself, not counting JUCE's parameter objects or thread stacks
+		size_t instanceBytes = 0;
+
+		// The tables in SulfuricTableCache, counted once however many instances share them
+		size_t sharedBytes = 0;
+		int sharedTables = 0;
+
+		// In the pool every instance shares
+		int workerThreads = 0;
+	};
+
+	/** Takes the table cache's lock, so ask from the message thread. */
+	MemoryFootprint getMemoryFootprint() const;
+
+	/** The footprint's instanceBytes as of the last prepareToPlay, cheap and safe to read from any thread. */
+	size_t getInstanceBytes() const noexcept { return instanceBytes.load(std::memory_order_relaxed); }
+
+private:
+	// One per output bus, null until prepareToPlay sees the bus enabled
+	std::vector<std::unique_ptr<SulfuricVoiceEngine>> synths;
+	std::unique_ptr<SulfuricVoiceEngine> createVoiceEngine() const;
+
+	template <typename Function>
+	void forEachSynth(Function&& function) const
+	{
+		for (auto& synth : synths)
+			if (synth != nullptr)
+				function(*synth);
+	}
+
+	juce::AudioProcessorValueTreeState params;
+
+	constexpr static const char* PATCH_PARAMETER_IDS[] = { "attack", "decay", "sustain", "release", "tune", "fine", "velocity", "filter", "cutoff", "resonance", "filterenv", "unison", "detune", "spread" };
+	juce::Array<juce::RangedAudioParameter*> patchParameters;
+
+	OscillatorQuality currentQuality;
+	void setOscillatorQuality(OscillatorQuality);
+
+	SulfuricEnvelope::Parameters currentEnvelope;
+	SulfuricEnvelope::Parameters getEnvelopeParameters() const noexcept;
+
+	SulfuricFilter::Parameters currentFilter;
+	SulfuricFilter::Parameters getFilterParameters() const noexcept;
+
+	SulfuricVoiceBank::Unison currentUnison;
+	SulfuricVoiceBank::Unison getUnisonParameters() const noexcept;
+
+	//==============================================================================
+	// process() reads the parameters from here, never from the atomics, so a block sees one consistent set of values
+	SulfuricParameterEngine parameterEngine;
+
+	// Indices into parameterEngine, in the order the constructor adds them
+	enum ParameterIndex { MASTER, QUALITY, POLYPHONY, ATTACK, DECAY, SUSTAIN, RELEASE, MULTICORE, TUNE, FINE, VELOCITY, FILTER, CUTOFF, RESONANCE, FILTER_ENVELOPE, UNISON, DETUNE, SPREAD };
+
+	// Long enough that automating master or sustain doesn't click
+	constexpr static double GAIN_SMOOTHING_SECONDS = 0.02;
+
+	template <typename SampleType>
+	void process(juce::AudioBuffer<SampleType>&, juce::MidiBuffer&);
+
+	//==============================================================================
+	// Room for this many MIDI events per block before processBlock falls back to scanning per bus
+	const static int MAX_MIDI_EVENTS_PER_BLOCK = 2048;
+	SulfuricMidiRouter midiRouter;
+
+	SulfuricLoadMeter loadMeter;
+	SulfuricScopeFeed scopeFeed;
+
+	// Left alone when rendering offline, where there is no deadline to miss
+	SulfuricCpuGovernor governor;
+
+	// The polyphony voices were last shed down to, 0 outside the shed tier
+	int shedPolyphony = 0;
+	const static int COARSE_CONTROL_INTERVAL = SulfuricVoiceEngine::DEFAULT_CONTROL_INTERVAL * 4;
+
+	//==============================================================================
+	// Renders the buses side by side when more than one has anything to do, or one bus's voices
+	// when there are enough of them. Shared by every instance, picked up by prepareToPlay.
+	std::shared_ptr<SulfuricWorkerPool> workerPool;
+	bool usesWorkerThreads = true;
+
+	// Measured where the allocations change, so readers never walk the engines while prepareToPlay resizes them
+	std::atomic<size_t> instanceBytes{ 0 };
+	std::atomic<int> numWorkerThreads{ 0 };
+	void measureMemory() noexcept;
+	const static int MAX_WORKERS = MAX_OUTPUT_BUSES - 1;
+
+	struct BusResult
+	{
+		bool isAudible = false;
+		juce::int64 gainTicks = 0;
+	};
+
+	std::array<int, MAX_OUTPUT_BUSES> busyBuses;
+	std::array<BusResult, MAX_OUTPUT_BUSES> busResults;
+
+	//==============================================================================
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SulfuricAudioProcessor)
 };
\ No newline at end of file
@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+	Every saved preset in one indexed file, memory mapped for browsing.
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+#include <mutex>
+
+//==============================================================================
+namespace
+{
+	constexpr char MAGIC[4] = { 'S', 'P', 'B', 'K' };
+}
+
+//==============================================================================
+SulfuricPresetBank::SulfuricPresetBank(std::unique_ptr<juce::MemoryMappedFile> mappedFile, int presets)
+	: file(std::move(mappedFile)), numPresets(presets)
+{
+}
+
+std::shared_ptr<const SulfuricPresetBank> SulfuricPresetBank::open(const juce::File& bankFile)
+{
+	auto mapped = std::make_unique<juce::MemoryMappedFile>(bankFile, juce::MemoryMappedFile::readOnly);
+
+	auto* data = static_cast<const char*>(mapped->getData());
+	auto size = mapped->getSize();
+
+	if (data == nullptr || size < (size_t)HEADER_SIZE
+		|| std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0
+		|| juce::ByteOrder::littleEndianInt(data + 4) != VERSION)
+		return nullptr;
+
+	auto numPresets = (size_t)juce::ByteOrder::littleEndianInt(data + 8);
+	if (size < HEADER_SIZE + numPresets * ENTRY_SIZE)
+		return nullptr;
+
+	// Every name and state has to lie inside the file
+	for (size_t index = 0; index < numPresets; ++index)
+	{
+		auto* entry = data + HEADER_SIZE + index * ENTRY_SIZE;
+
+		for (auto field = 0; field < 2; ++field)
+		{
+			auto offset = (size_t)juce::ByteOrder::littleEndianInt(entry + field * 8);
+			auto length = (size_t)juce::ByteOrder::littleEndianInt(entry + field * 8 + 4);
+
+			if (offset > size || length > size - offset)
+				return nullptr;
+		}
+	}
+
+	// Fault every page in now, rather than the first time the message thread looks at a preset
+	const auto pageSize = (size_t)4096;
+	volatile char sink = 0;
+	for (size_t offset = 0; offset < size; offset += pageSize)
+		sink = sink + data[offset];
+
+	return std::shared_ptr<const SulfuricPresetBank>(new SulfuricPresetBank(std::move(mapped), (int)numPresets));
+}
+
+bool SulfuricPresetBank::write(const juce::File& bankFile, const std::vector<Preset>& presets)
+{
+	juce::MemoryOutputStream names, states;
+	juce::MemoryOutputStream out;
+
+	auto dataStart = (juce::uint32)(HEADER_SIZE + presets.size() * ENTRY_SIZE);
+
+	out.write(MAGIC, sizeof(MAGIC));
+	out.writeInt((int)VERSION);
+	out.writeInt((int)presets.size());
+
+	// Names first, then states, both straight after the index
+	juce::uint32 namesSize = 0;
+	for (auto& preset : presets)
+		namesSize += (juce::uint32)preset.name.getNumBytesAsUTF8();
+
+	juce::uint32 nameOffset = dataStart, stateOffset = dataStart + namesSize;
+
+	for (auto& preset : presets)
+	{
+		auto nameSize = (juce::uint32)preset.name.getNumBytesAsUTF8();
+		auto stateSize = (juce::uint32)preset.state.getSize();
+
+		out.writeInt((int)nameOffset);
+		out.writeInt((int)nameSize);
+		out.writeInt((int)stateOffset);
+		out.writeInt((int)stateSize);
+
+		names.write(preset.name.toRawUTF8(), nameSize);
+		states.write(preset.state.getData(), stateSize);
+
+		nameOffset += nameSize;
+		stateOffset += stateSize;
+	}
+
+	out << names.getMemoryBlock() << states.getMemoryBlock();
+
+	// Written next to the bank and moved over it, so a bank that is open elsewhere is never seen half written
+	juce::TemporaryFile temporary(bankFile);
+
+	if (!bankFile.getParentDirectory().createDirectory()
+		|| !temporary.getFile().replaceWithData(out.getData(), out.getDataSize()))
+		return false;
+
+	return temporary.overwriteTargetFileWithTemporary();
+}
+
+int SulfuricPresetBank::append(const juce::File& bankFile, const Preset& preset)
+{
+	// Instances in one host share a process, and the interprocess lock doesn't keep them apart on every system
+	static std::mutex processLock;
+	const std::lock_guard<std::mutex> processGuard(processLock);
+
+	juce::InterProcessLock lock("SulfuricPresetBank-" + juce::String::toHexString(bankFile.getFullPathName().hashCode64()));
+	if (!lock.enter(LOCK_TIMEOUT_MS))
+		return -1;
+
+	std::vector<Preset> presets;
+	if (auto current = open(bankFile))
+		presets = current->getPresets();
+
+	// The mapping is gone again by here, some systems won't replace a file that is mapped
+	presets.push_back(preset);
+	auto index = write(bankFile, presets) ? (int)presets.size() - 1 : -1;
+
+	lock.exit();
+	return index;
+}
+
+juce::File SulfuricPresetBank::getDefaultFile()
+{
+	return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+		.getChildFile("Sulfuric")
+		.getChildFile("Presets.sulfuricbank");
+}
+
+//==============================================================================
+const char* SulfuricPresetBank::getEntry(int index) const noexcept
+{
+	jassert(juce::isPositiveAndBelow(index, numPresets));
+	return static_cast<const char*>(file->getData()) + HEADER_SIZE + index * ENTRY_SIZE;
+}
+
+juce::String SulfuricPresetBank::getName(int index) const
+{
+	auto* entry = getEntry(index);
+	auto* base = static_cast<const char*>(file->getData());
+
+	return juce::String::fromUTF8(base + juce::ByteOrder::littleEndianInt(entry), (int)juce::ByteOrder::littleEndianInt(entry + 4));
+}
+
+SulfuricPresetBank::State SulfuricPresetBank::getState(int index) const noexcept
+{
+	auto* entry = getEntry(index);
+	auto* base = static_cast<const char*>(file->getData());
+
+	return { base + juce::ByteOrder::littleEndianInt(entry + 8), (int)juce::ByteOrder::littleEndianInt(entry + 12) };
+}
+
+std::vector<SulfuricPresetBank::Preset> SulfuricPresetBank::getPresets() const
+{
+	std::vector<Preset> presets((size_t)numPresets);
+
+	for (auto index = 0; index < numPresets; ++index)
+	{
+		auto state = getState(index);
+		presets[(size_t)index].name = getName(index);
+		presets[(size_t)index].state.replaceAll(state.data, (size_t)state.size);
+	}
+
+	return presets;
+}
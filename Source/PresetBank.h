@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+	Every saved preset in one indexed file, memory mapped for browsing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+//==============================================================================
+/**
+	Layout, all little-endian:
+
+		char[4]		"SPBK"
+		uint32		version
+		uint32		number of presets
+		then per preset
+			uint32	name offset, from the start of the file
+			uint32	name size, UTF-8 without a terminator
+			uint32	state offset
+			uint32	state size, in the format getStateInformation writes
+		then the names and states
+
+	open() maps the file and reads every page in once, so browsing and loading
+	presets afterwards only touches memory. Open and write banks off the
+	message thread; a bank never changes once opened, saving writes a new file.
+*/
+class SulfuricPresetBank
+{
+public:
+	struct Preset
+	{
+		juce::String name;
+		juce::MemoryBlock state;
+	};
+
+	struct State
+	{
+		const void* data = nullptr;
+		int size = 0;
+	};
+
+	const static juce::uint32 VERSION = 1;
+
+	/** Nullptr if the file is missing or not a valid bank. */
+	static std::shared_ptr<const SulfuricPresetBank> open(const juce::File&);
+
+	/** Writes a bank holding presets, replacing the file only once the new one is complete. */
+	static bool write(const juce::File&, const std::vector<Preset>&);
+
+	/**
+		Adds preset to the end of the bank as it is on disk right now, creating the bank if there is
+		none, and returns the new preset's index, or -1 if the bank couldn't be written.
+
+		Every instance in every process takes turns, so presets saved elsewhere in the meantime are
+		kept. Call it off the message thread, it may wait for another instance to finish saving.
+	*/
+	static int append(const juce::File&, const Preset&);
+
+	/** Where the plugin keeps its presets. */
+	static juce::File getDefaultFile();
+
+	int getNumPresets() const noexcept { return numPresets; }
+	juce::String getName(int index) const;
+
+	/** Points into the mapped file, valid as long as the bank is. */
+	State getState(int index) const noexcept;
+
+	/** Copies everything out, to write a bank with changes. */
+	std::vector<Preset> getPresets() const;
+
+private:
+	SulfuricPresetBank(std::unique_ptr<juce::MemoryMappedFile>, int numPresets);
+
+	const char* getEntry(int index) const noexcept;
+
+	std::unique_ptr<juce::MemoryMappedFile> file;
+	int numPresets;
+
+	// Long enough for any other instance to write a bank
+	const static int LOCK_TIMEOUT_MS = 5000;
+
+	const static int HEADER_SIZE = 12;
+	const static int ENTRY_SIZE = 16;
+};
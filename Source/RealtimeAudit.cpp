@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+	Catches the audio thread allocating, locking or making blocking system
+	calls, in builds configured with SULFURIC_REALTIME_AUDIT.
+
+  ==============================================================================
+*/
+
+#include "RealtimeAudit.h"
+
+#include <cstdio>
+
+//==============================================================================
+namespace
+{
+	// Plain ints, so reading them from inside malloc can't allocate
+	thread_local int scopeDepth = 0;
+	thread_local bool isReporting = false;
+
+	std::atomic<int> numViolations{ 0 };
+
+	void printViolation(const char* what, const juce::String& stackTrace)
+	{
+		std::fprintf(stderr, "Real-time violation: %s on the audio thread\n%s\n", what, stackTrace.toRawUTF8());
+	}
+
+	std::atomic<SulfuricRealtimeAudit::Handler> handler{ printViolation };
+}
+
+//==============================================================================
+void SulfuricRealtimeAudit::setHandler(Handler newHandler) noexcept
+{
+	handler = newHandler != nullptr ? newHandler : printViolation;
+}
+
+void SulfuricRealtimeAudit::enter() noexcept
+{
+	++scopeDepth;
+}
+
+void SulfuricRealtimeAudit::exit() noexcept
+{
+	jassert(scopeDepth > 0);
+	--scopeDepth;
+}
+
+bool SulfuricRealtimeAudit::isInside() noexcept
+{
+	return scopeDepth > 0;
+}
+
+void SulfuricRealtimeAudit::check(const char* what) noexcept
+{
+	if (scopeDepth == 0 || isReporting)
+		return;
+
+	// Reporting allocates and locks too, none of which counts
+	isReporting = true;
+	numViolations.fetch_add(1, std::memory_order_relaxed);
+	handler.load()(what, juce::SystemStats::getStackBacktrace());
+	isReporting = false;
+}
+
+int SulfuricRealtimeAudit::getNumViolations() noexcept
+{
+	return numViolations.load(std::memory_order_relaxed);
+}
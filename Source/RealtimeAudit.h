@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+	Catches the audio thread allocating, locking or making blocking system
+	calls, in builds configured with SULFURIC_REALTIME_AUDIT.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#ifndef SULFURIC_REALTIME_AUDIT
+	#define SULFURIC_REALTIME_AUDIT 0
+#endif
+
+//==============================================================================
+/**
+	Code that must stay real-time safe opens a SULFURIC_REALTIME_SCOPE(). The
+	hooks in Tests/RealtimeAuditHooks.cpp wrap malloc and free, operator new and
+	delete, mutex locks, sleeps, file I/O and raw system calls, and call check()
+	first. Inside a scope on the calling thread that is a violation, reported with
+	a stack trace. Futex wakes are let through, they never wait on another thread.
+
+	With SULFURIC_REALTIME_AUDIT off, the default, the macro is empty and nothing
+	is hooked.
+*/
+class SulfuricRealtimeAudit
+{
+public:
+	/** Gets every violation, on the thread that made it. The default prints it to stderr. */
+	using Handler = void (*)(const char* what, const juce::String& stackTrace);
+	static void setHandler(Handler) noexcept;
+
+	/** Scopes nest, the thread is audited until the outermost one closes. */
+	struct Scope
+	{
+		Scope() noexcept { enter(); }
+		~Scope() noexcept { exit(); }
+
+		JUCE_DECLARE_NON_COPYABLE(Scope)
+	};
+
+	static void enter() noexcept;
+	static void exit() noexcept;
+	static bool isInside() noexcept;
+
+	/** For the hooks. Reports what if the calling thread is inside a scope. */
+	static void check(const char* what) noexcept;
+
+	/** Every violation on any thread since the program started. */
+	static int getNumViolations() noexcept;
+};
+
+#if SULFURIC_REALTIME_AUDIT
+	#define SULFURIC_REALTIME_SCOPE() const SulfuricRealtimeAudit::Scope sulfuricRealtimeScope
+#else
+	#define SULFURIC_REALTIME_SCOPE()
+#endif
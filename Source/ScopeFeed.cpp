@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+	Output samples for the editor's scope and spectrum, handed from the audio
+	thread to the message thread without ever blocking it.
+
+  ==============================================================================
+*/
+
+#include "ScopeFeed.h"
+
+//==============================================================================
+void SulfuricScopeFeed::prepare(double sampleRate) noexcept
+{
+	decimation = juce::jmax(1, (int)std::ceil(sampleRate / MAX_FEED_RATE - 1.0e-6));
+	feedSampleRate = sampleRate / decimation;
+
+	sum = 0.0f;
+	numSummed = 0;
+	numDropped = 0;
+}
+
+void SulfuricScopeFeed::addViewer() noexcept
+{
+	numViewers.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SulfuricScopeFeed::removeViewer() noexcept
+{
+	jassert(numViewers > 0);
+	numViewers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void SulfuricScopeFeed::push(const juce::AudioBuffer<float>& buffer) noexcept
+{
+	write(buffer);
+}
+
+void SulfuricScopeFeed::push(const juce::AudioBuffer<double>& buffer) noexcept
+{
+	write(buffer);
+}
+
+template <typename SampleType>
+void SulfuricScopeFeed::write(const juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+	if (!isActive() || buffer.getNumChannels() == 0)
+		return;
+
+	auto numChannels = juce::jmin(2, buffer.getNumChannels());
+	auto* left = buffer.getReadPointer(0);
+	auto* right = buffer.getReadPointer(numChannels - 1);
+	auto scale = 1.0f / (float)(numChannels * decimation);
+
+	int start1, size1, start2, size2;
+	fifo.prepareToWrite(buffer.getNumSamples() / decimation + 1, start1, size1, start2, size2);
+
+	auto written = 0;
+	auto room = size1 + size2;
+
+	for (auto i = 0; i < buffer.getNumSamples(); ++i)
+	{
+		sum += (float)left[i] + (numChannels > 1 ? (float)right[i] : 0.0f);
+		if (++numSummed < decimation)
+			continue;
+
+		if (written < room)
+			samples[(size_t)(written < size1 ? start1 + written : start2 + written - size1)] = sum * scale;
+
+		++written;
+		sum = 0.0f;
+		numSummed = 0;
+	}
+
+	fifo.finishedWrite(juce::jmin(written, room));
+
+	if (written > room)
+		numDropped.fetch_add((juce::uint64)(written - room), std::memory_order_relaxed);
+}
+
+int SulfuricScopeFeed::pull(float* destination, int maxSamples) noexcept
+{
+	int start1, size1, start2, size2;
+	fifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+
+	std::copy_n(samples.data() + start1, size1, destination);
+	std::copy_n(samples.data() + start2, size2, destination + size1);
+
+	fifo.finishedRead(size1 + size2);
+	return size1 + size2;
+}
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+	Output samples for the editor's scope and spectrum, handed from the audio
+	thread to the message thread without ever blocking it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+//==============================================================================
+/**
+	The audio thread pushes every block's main output, mixed to mono and averaged
+	down to around 48 kHz, and a viewer on the message thread pulls it.
+
+	Nobody watching costs push() one atomic load. Otherwise it is one pass over
+	the block's first two channels, and whatever doesn't fit because the viewer
+	has fallen behind is dropped rather than waited for.
+*/
+class SulfuricScopeFeed
+{
+public:
+	/** Call before playback starts, not concurrently with push(). Leaves what is already queued to the viewer. */
+	void prepare(double sampleRate) noexcept;
+
+	/** Message thread. The feed runs while at least one viewer is attached. */
+	void addViewer() noexcept;
+	void removeViewer() noexcept;
+	bool isActive() const noexcept { return numViewers.load(std::memory_order_relaxed) > 0; }
+
+	/** Audio thread only. Wait-free. */
+	void push(const juce::AudioBuffer<float>&) noexcept;
+	void push(const juce::AudioBuffer<double>&) noexcept;
+
+	/** Reader thread only. Copies out up to maxSamples of the oldest queued samples and returns how many. */
+	int pull(float* destination, int maxSamples) noexcept;
+
+	/** The rate of what pull() returns. */
+	double getFeedSampleRate() const noexcept { return feedSampleRate.load(std::memory_order_relaxed); }
+
+	/** Samples that didn't fit since prepare(). */
+	juce::uint64 getNumDropped() const noexcept { return numDropped.load(std::memory_order_relaxed); }
+
+	const static int CAPACITY = 16384;
+
+	// Anything faster is averaged down, which is also all the low pass the decimation gets
+	constexpr static double MAX_FEED_RATE = 48000.0;
+
+private:
+	template <typename SampleType>
+	void write(const juce::AudioBuffer<SampleType>&) noexcept;
+
+	std::atomic<int> numViewers{ 0 };
+	std::atomic<double> feedSampleRate{ 44100.0 };
+	std::atomic<juce::uint64> numDropped{ 0 };
+
+	juce::AbstractFifo fifo{ CAPACITY };
+	std::array<float, CAPACITY> samples{};
+
+	// Audio thread side, a decimation window carries over from one block to the next
+	int decimation = 1;
+	float sum = 0.0f;
+	int numSummed = 0;
+};
@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+	The editor's oscilloscope and spectrum, drawn from SulfuricScopeFeed.
+
+  ==============================================================================
+*/
+
+#include "ScopeView.h"
+
+//==============================================================================
+SulfuricScopeView::SulfuricScopeView(SulfuricScopeFeed& scopeFeed, juce::Colour backgroundColour, juce::Colour traceColour)
+	: feed(scopeFeed), background(backgroundColour), trace(traceColour)
+{
+	setOpaque(true);
+	spectrumDb.fill(MIN_DB);
+
+	// Whatever is still queued is from the last time the editor was open
+	feed.addViewer();
+	feed.pull(incoming.data(), (int)incoming.size());
+
+	startTimerHz(REFRESH_HZ);
+}
+
+SulfuricScopeView::~SulfuricScopeView()
+{
+	feed.removeViewer();
+}
+
+//==============================================================================
+void SulfuricScopeView::paint(juce::Graphics& g)
+{
+	g.fillAll(background);
+
+	g.setColour(trace.withAlpha(0.25f));
+	g.drawHorizontalLine(juce::roundToInt(scopeArea.getCentreY()), scopeArea.getX(), scopeArea.getRight());
+	g.drawHorizontalLine(juce::roundToInt(spectrumArea.getBottom()), spectrumArea.getX(), spectrumArea.getRight());
+
+	g.setColour(trace);
+	g.strokePath(scopePath, juce::PathStrokeType(1.5f));
+	g.strokePath(spectrumPath, juce::PathStrokeType(1.5f));
+}
+
+void SulfuricScopeView::resized()
+{
+	auto bounds = getLocalBounds().toFloat().reduced(4.0f);
+
+	scopeArea = bounds.removeFromTop(bounds.getHeight() / 2.0f).reduced(0.0f, 2.0f);
+	spectrumArea = bounds.reduced(0.0f, 2.0f);
+
+	updatePaths();
+}
+
+void SulfuricScopeView::timerCallback()
+{
+	// With the transport stopped nothing arrives, and nothing needs repainting
+	if (!readFeed())
+		return;
+
+	updateSpectrum();
+	updatePaths();
+	repaint();
+}
+
+//==============================================================================
+bool SulfuricScopeView::readFeed()
+{
+	auto numSamples = feed.pull(incoming.data(), (int)incoming.size());
+
+	// Only the latest FFT_SIZE samples can still be seen
+	for (auto i = juce::jmax(0, numSamples - FFT_SIZE); i < numSamples; ++i)
+	{
+		history[(size_t)historyPosition] = incoming[(size_t)i];
+		historyPosition = (historyPosition + 1) % FFT_SIZE;
+	}
+
+	return numSamples > 0;
+}
+
+void SulfuricScopeView::updateSpectrum()
+{
+	for (auto i = 0; i < FFT_SIZE; ++i)
+		fftData[(size_t)i] = history[(size_t)((historyPosition + i) % FFT_SIZE)];
+
+	std::fill(fftData.begin() + FFT_SIZE, fftData.end(), 0.0f);
+
+	window.multiplyWithWindowingTable(fftData.data(), (size_t)FFT_SIZE);
+	fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+	// A full scale sine peaks at FFT_SIZE / 4 through the Hann window, scale that to 0 dB
+	for (size_t bin = 0; bin < spectrumDb.size(); ++bin)
+	{
+		auto level = juce::Decibels::gainToDecibels(fftData[bin] * 4.0f / (float)FFT_SIZE, MIN_DB);
+		spectrumDb[bin] = juce::jmax(level, spectrumDb[bin] - FALL_DB_PER_REFRESH);
+	}
+}
+
+void SulfuricScopeView::updatePaths()
+{
+	auto sample = [this](int index) { return history[(size_t)((historyPosition + index) % FFT_SIZE)]; };
+
+	// The latest rising zero crossing that still leaves SCOPE_SAMPLES to show, so a steady tone stands still
+	auto start = FFT_SIZE - SCOPE_SAMPLES;
+	for (auto i = start; i > 0; --i)
+	{
+		if (sample(i - 1) < 0.0f && sample(i) >= 0.0f)
+		{
+			start = i;
+			break;
+		}
+	}
+
+	scopePath.clear();
+	for (auto i = 0; i < SCOPE_SAMPLES; ++i)
+	{
+		auto x = scopeArea.getX() + scopeArea.getWidth() * (float)i / (float)(SCOPE_SAMPLES - 1);
+		auto y = scopeArea.getCentreY() - juce::jlimit(-1.0f, 1.0f, sample(start + i)) * scopeArea.getHeight() / 2.0f;
+
+		if (i == 0)
+			scopePath.startNewSubPath(x, y);
+		else
+			scopePath.lineTo(x, y);
+	}
+
+	// Logarithmic in frequency from MIN_HZ to Nyquist
+	spectrumPath.clear();
+	auto binHz = (float)feed.getFeedSampleRate() / (float)FFT_SIZE;
+	auto octaves = std::log2(binHz * (float)(FFT_SIZE / 2) / MIN_HZ);
+
+	for (size_t bin = 1; bin < spectrumDb.size(); ++bin)
+	{
+		auto hz = binHz * (float)bin;
+		if (hz < MIN_HZ)
+			continue;
+
+		auto x = spectrumArea.getX() + spectrumArea.getWidth() * std::log2(hz / MIN_HZ) / octaves;
+		auto y = juce::jmap(spectrumDb[bin], MIN_DB, 0.0f, spectrumArea.getBottom(), spectrumArea.getY());
+
+		if (spectrumPath.isEmpty())
+			spectrumPath.startNewSubPath(x, y);
+		else
+			spectrumPath.lineTo(x, y);
+	}
+}
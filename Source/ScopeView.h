@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+	The editor's oscilloscope and spectrum, drawn from SulfuricScopeFeed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "ScopeFeed.h"
+
+//==============================================================================
+/**
+	Attaches to the feed for as long as it exists, so the audio thread only
+	feeds it while the editor is open. Everything else, the FFT included,
+	happens on the message thread at REFRESH_HZ.
+*/
+class SulfuricScopeView : public juce::Component, private juce::Timer
+{
+public:
+	SulfuricScopeView(SulfuricScopeFeed&, juce::Colour background, juce::Colour trace);
+	~SulfuricScopeView() override;
+
+	void paint(juce::Graphics&) override;
+	void resized() override;
+
+	const static int REFRESH_HZ = 30;
+
+	const static int FFT_ORDER = 11;
+	const static int FFT_SIZE = 1 << FFT_ORDER;
+
+	// The scope shows this much of the latest output, starting from a rising zero crossing when there is one
+	const static int SCOPE_SAMPLES = 1024;
+
+	constexpr static float MIN_DB = -96.0f;
+	constexpr static float MIN_HZ = 20.0f;
+
+	// How fast the spectrum falls back once a peak has passed
+	constexpr static float FALL_DB_PER_REFRESH = 1.5f;
+
+private:
+	void timerCallback() override;
+
+	// Pulls whatever the feed has into history, returns whether anything arrived
+	bool readFeed();
+	void updateSpectrum();
+	void updatePaths();
+
+	SulfuricScopeFeed& feed;
+	juce::Colour background, trace;
+
+	// The latest FFT_SIZE feed samples, oldest first once unrolled from historyPosition
+	std::array<float, FFT_SIZE> history{};
+	int historyPosition = 0;
+	std::array<float, SulfuricScopeFeed::CAPACITY> incoming;
+
+	juce::dsp::FFT fft{ FFT_ORDER };
+	juce::dsp::WindowingFunction<float> window{ (size_t)FFT_SIZE, juce::dsp::WindowingFunction<float>::hann };
+	std::array<float, FFT_SIZE * 2> fftData{};
+
+	// Per bin, in dB, falling back slowly so peaks stay readable
+	std::array<float, FFT_SIZE / 2> spectrumDb;
+
+	juce::Rectangle<float> scopeArea, spectrumArea;
+	juce::Path scopePath, spectrumPath;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SulfuricScopeView)
+};
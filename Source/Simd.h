@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+	Minimal SIMD wrappers for the voice bank and parameter smoothing: AVX2
+	(8 lanes), SSE2 (4 lanes) or plain scalar code (1 lane), picked at compile time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define SULFURIC_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define SULFURIC_SIMD_SSE2 1
+#endif
+
+//==============================================================================
+#if SULFURIC_SIMD_AVX2
+
+struct SimdFloat
+{
+	const static int WIDTH = 8;
+	__m256 v;
+
+	static SimdFloat load(const float* p) noexcept { return { _mm256_loadu_ps(p) }; }
+	static SimdFloat broadcast(float x) noexcept { return { _mm256_set1_ps(x) }; }
+	void store(float* p) const noexcept { _mm256_storeu_ps(p, v); }
+
+	SimdFloat operator+(SimdFloat o) const noexcept { return { _mm256_add_ps(v, o.v) }; }
+	SimdFloat operator-(SimdFloat o) const noexcept { return { _mm256_sub_ps(v, o.v) }; }
+	SimdFloat operator*(SimdFloat o) const noexcept { return { _mm256_mul_ps(v, o.v) }; }
+	static SimdFloat max(SimdFloat a, SimdFloat b) noexcept { return { _mm256_max_ps(a.v, b.v) }; }
+
+	/** All bits set in the lanes where this <= o. */
+	SimdFloat lessOrEqual(SimdFloat o) const noexcept { return { _mm256_cmp_ps(v, o.v, _CMP_LE_OQ) }; }
+
+	/** Lanes of a where mask is set, lanes of b elsewhere. */
+	static SimdFloat select(SimdFloat mask, SimdFloat a, SimdFloat b) noexcept { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+
+	float sum() const noexcept
+	{
+		auto half = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+		half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+		half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+		return _mm_cvtss_f32(half);
+	}
+};
+
+struct SimdInt
+{
+	const static int WIDTH = 8;
+	__m256i v;
+
+	static SimdInt load(const uint32_t* p) noexcept { return { _mm256_loadu_si256((const __m256i*)p) }; }
+	static SimdInt broadcast(uint32_t x) noexcept { return { _mm256_set1_epi32((int)x) }; }
+	void store(uint32_t* p) const noexcept { _mm256_storeu_si256((__m256i*)p, v); }
+
+	SimdInt operator+(SimdInt o) const noexcept { return { _mm256_add_epi32(v, o.v) }; }
+	SimdInt operator&(SimdInt o) const noexcept { return { _mm256_and_si256(v, o.v) }; }
+	template <int bits> SimdInt shiftRight() const noexcept { return { _mm256_srli_epi32(v, bits) }; }
+
+	/** Lanes must hold values below 2^31. */
+	SimdFloat toFloat() const noexcept { return { _mm256_cvtepi32_ps(v) }; }
+
+	/** base[lane] for every lane, indices must be below 2^31. */
+	static SimdFloat gather(const float* base, SimdInt index) noexcept { return { _mm256_i32gather_ps(base, index.v, 4) }; }
+
+	/** base[lane], base[lane + 1], base[lane + 2] and base[lane + 3] for every lane. */
+	static void gather4(const float* base, SimdInt index, SimdFloat& a, SimdFloat& b, SimdFloat& c, SimdFloat& d) noexcept
+	{
+		a = gather(base, index);
+		b = gather(base + 1, index);
+		c = gather(base + 2, index);
+		d = gather(base + 3, index);
+	}
+};
+
+//==============================================================================
+#elif SULFURIC_SIMD_SSE2
+
+struct SimdFloat
+{
+	const static int WIDTH = 4;
+	__m128 v;
+
+	static SimdFloat load(const float* p) noexcept { return { _mm_loadu_ps(p) }; }
+	static SimdFloat broadcast(float x) noexcept { return { _mm_set1_ps(x) }; }
+	void store(float* p) const noexcept { _mm_storeu_ps(p, v); }
+
+	SimdFloat operator+(SimdFloat o) const noexcept { return { _mm_add_ps(v, o.v) }; }
+	SimdFloat operator-(SimdFloat o) const noexcept { return { _mm_sub_ps(v, o.v) }; }
+	SimdFloat operator*(SimdFloat o) const noexcept { return { _mm_mul_ps(v, o.v) }; }
+	static SimdFloat max(SimdFloat a, SimdFloat b) noexcept { return { _mm_max_ps(a.v, b.v) }; }
+
+	SimdFloat lessOrEqual(SimdFloat o) const noexcept { return { _mm_cmple_ps(v, o.v) }; }
+	static SimdFloat select(SimdFloat mask, SimdFloat a, SimdFloat b) noexcept { return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) }; }
+
+	float sum() const noexcept
+	{
+		auto half = _mm_add_ps(v, _mm_movehl_ps(v, v));
+		half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+		return _mm_cvtss_f32(half);
+	}
+};
+
+struct SimdInt
+{
+	const static int WIDTH = 4;
+	__m128i v;
+
+	static SimdInt load(const uint32_t* p) noexcept { return { _mm_loadu_si128((const __m128i*)p) }; }
+	static SimdInt broadcast(uint32_t x) noexcept { return { _mm_set1_epi32((int)x) }; }
+	void store(uint32_t* p) const noexcept { _mm_storeu_si128((__m128i*)p, v); }
+
+	SimdInt operator+(SimdInt o) const noexcept { return { _mm_add_epi32(v, o.v) }; }
+	SimdInt operator&(SimdInt o) const noexcept { return { _mm_and_si128(v, o.v) }; }
+	template <int bits> SimdInt shiftRight() const noexcept { return { _mm_srli_epi32(v, bits) }; }
+
+	SimdFloat toFloat() const noexcept { return { _mm_cvtepi32_ps(v) }; }
+
+	// SSE2 has no gather
+	static SimdFloat gather(const float* base, SimdInt index) noexcept
+	{
+		alignas(16) uint32_t i[WIDTH];
+		_mm_store_si128((__m128i*)i, index.v);
+		return { _mm_setr_ps(base[i[0]], base[i[1]], base[i[2]], base[i[3]]) };
+	}
+
+	// Four unaligned loads and a transpose beat sixteen scalar loads
+	static void gather4(const float* base, SimdInt index, SimdFloat& a, SimdFloat& b, SimdFloat& c, SimdFloat& d) noexcept
+	{
+		alignas(16) uint32_t i[WIDTH];
+		_mm_store_si128((__m128i*)i, index.v);
+
+		auto r0 = _mm_loadu_ps(base + i[0]), r1 = _mm_loadu_ps(base + i[1]);
+		auto r2 = _mm_loadu_ps(base + i[2]), r3 = _mm_loadu_ps(base + i[3]);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		a = { r0 };
+		b = { r1 };
+		c = { r2 };
+		d = { r3 };
+	}
+};
+
+//==============================================================================
+#else
+
+struct SimdFloat
+{
+	const static int WIDTH = 1;
+	float v;
+
+	static SimdFloat load(const float* p) noexcept { return { *p }; }
+	static SimdFloat broadcast(float x) noexcept { return { x }; }
+	void store(float* p) const noexcept { *p = v; }
+
+	SimdFloat operator+(SimdFloat o) const noexcept { return { v + o.v }; }
+	SimdFloat operator-(SimdFloat o) const noexcept { return { v - o.v }; }
+	SimdFloat operator*(SimdFloat o) const noexcept { return { v * o.v }; }
+	static SimdFloat max(SimdFloat a, SimdFloat b) noexcept { return { a.v > b.v ? a.v : b.v }; }
+
+	// Any non-zero value is a set mask
+	SimdFloat lessOrEqual(SimdFloat o) const noexcept { return { v <= o.v ? 1.0f : 0.0f }; }
+	static SimdFloat select(SimdFloat mask, SimdFloat a, SimdFloat b) noexcept { return mask.v != 0.0f ? a : b; }
+
+	float sum() const noexcept { return v; }
+};
+
+struct SimdInt
+{
+	const static int WIDTH = 1;
+	uint32_t v;
+
+	static SimdInt load(const uint32_t* p) noexcept { return { *p }; }
+	static SimdInt broadcast(uint32_t x) noexcept { return { x }; }
+	void store(uint32_t* p) const noexcept { *p = v; }
+
+	SimdInt operator+(SimdInt o) const noexcept { return { v + o.v }; }
+	SimdInt operator&(SimdInt o) const noexcept { return { v & o.v }; }
+	template <int bits> SimdInt shiftRight() const noexcept { return { v >> bits }; }
+
+	SimdFloat toFloat() const noexcept { return { (float)v }; }
+	static SimdFloat gather(const float* base, SimdInt index) noexcept { return { base[index.v] }; }
+
+	static void gather4(const float* base, SimdInt index, SimdFloat& a, SimdFloat& b, SimdFloat& c, SimdFloat& d) noexcept
+	{
+		a = { base[index.v] };
+		b = { base[index.v + 1] };
+		c = { base[index.v + 2] };
+		d = { base[index.v + 3] };
+	}
+};
+
+#endif
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+	The plugin's saved state: a small versioned binary block of parameter
+	values, with the old XML state still readable.
+
+  ==============================================================================
+*/
+
+#include "StateFormat.h"
+
+//==============================================================================
+namespace
+{
+	constexpr char MAGIC[4] = { 'S', 'U', 'L', 'F' };
+
+	const juce::RangedAudioParameter* withID(const juce::AudioProcessorParameter* parameter) noexcept
+	{
+		return dynamic_cast<const juce::RangedAudioParameter*>(parameter);
+	}
+}
+
+//==============================================================================
+void SulfuricStateFormat::write(const juce::Array<juce::AudioProcessorParameter*>& parameters, juce::MemoryBlock& destData)
+{
+	auto numParameters = 0;
+	for (auto* parameter : parameters)
+		numParameters += withID(parameter) != nullptr ? 1 : 0;
+
+	destData.setSize((size_t)(HEADER_SIZE + numParameters * ENTRY_SIZE));
+	auto* out = static_cast<char*>(destData.getData());
+
+	std::memcpy(out, MAGIC, sizeof(MAGIC));
+	juce::ByteOrder::writeLittleEndianShort(out + 4, VERSION);
+	juce::ByteOrder::writeLittleEndianShort(out + 6, (juce::uint16)numParameters);
+	out += HEADER_SIZE;
+
+	for (auto* parameter : parameters)
+	{
+		auto* ranged = withID(parameter);
+		if (ranged == nullptr)
+			continue;
+
+		auto value = ranged->getValue();
+		juce::uint32 bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		juce::ByteOrder::writeLittleEndianInt(out, hashParameterID(ranged->paramID));
+		juce::ByteOrder::writeLittleEndianInt(out + 4, bits);
+		out += ENTRY_SIZE;
+	}
+}
+
+bool SulfuricStateFormat::isBinaryState(const void* data, int sizeInBytes) noexcept
+{
+	if (data == nullptr || sizeInBytes < HEADER_SIZE)
+		return false;
+
+	auto* in = static_cast<const char*>(data);
+	auto version = juce::ByteOrder::littleEndianShort(in + 4);
+	auto numParameters = (int)juce::ByteOrder::littleEndianShort(in + 6);
+
+	return std::memcmp(in, MAGIC, sizeof(MAGIC)) == 0
+		&& version >= 1 && version <= VERSION
+		&& sizeInBytes >= HEADER_SIZE + numParameters * ENTRY_SIZE;
+}
+
+bool SulfuricStateFormat::read(const juce::Array<juce::AudioProcessorParameter*>& parameters, const void* data, int sizeInBytes)
+{
+	if (!isBinaryState(data, sizeInBytes))
+		return false;
+
+	auto* entries = static_cast<const char*>(data) + HEADER_SIZE;
+	auto numEntries = (int)juce::ByteOrder::littleEndianShort(static_cast<const char*>(data) + 6);
+
+	for (auto* parameter : parameters)
+	{
+		auto* ranged = withID(parameter);
+		if (ranged == nullptr)
+			continue;
+
+		auto hash = hashParameterID(ranged->paramID);
+		auto value = parameter->getDefaultValue();
+
+		// A dozen or so parameters, a linear search beats building anything
+		for (auto entry = 0; entry < numEntries; ++entry)
+		{
+			auto* in = entries + entry * ENTRY_SIZE;
+			if (juce::ByteOrder::littleEndianInt(in) != hash)
+				continue;
+
+			auto bits = juce::ByteOrder::littleEndianInt(in + 4);
+			std::memcpy(&value, &bits, sizeof(value));
+			break;
+		}
+
+		if (!std::isfinite(value))
+			value = parameter->getDefaultValue();
+
+		parameter->setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, value));
+	}
+
+	return true;
+}
+
+juce::uint32 SulfuricStateFormat::hashParameterID(const juce::String& parameterID) noexcept
+{
+	juce::uint32 hash = 2166136261u;
+
+	for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+	{
+		hash ^= (juce::uint8)*c;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
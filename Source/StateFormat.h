@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+	The plugin's saved state: a small versioned binary block of parameter
+	values, with the old XML state still readable.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+//==============================================================================
+/**
+	Layout, all little-endian:
+
+		char[4]		"SULF"
+		uint16		version
+		uint16		number of parameters
+		then per parameter
+			uint32	FNV-1a hash of the parameter ID
+			float	normalised value
+
+	Parameters are matched by ID hash, so adding, removing or reordering
+	parameters keeps older states loading. A parameter the state doesn't mention
+	goes back to its default.
+*/
+class SulfuricStateFormat
+{
+public:
+	const static juce::uint16 VERSION = 1;
+
+	/** Replaces destData with every parameter that has an ID. */
+	static void write(const juce::Array<juce::AudioProcessorParameter*>&, juce::MemoryBlock& destData);
+
+	/** True if data starts like a state write() produced, of this version or older. */
+	static bool isBinaryState(const void* data, int sizeInBytes) noexcept;
+
+	/** Sets every parameter from a binary state, without allocating. Returns false and changes nothing if the state is not one. */
+	static bool read(const juce::Array<juce::AudioProcessorParameter*>&, const void* data, int sizeInBytes);
+
+	static juce::uint32 hashParameterID(const juce::String&) noexcept;
+
+private:
+	const static int HEADER_SIZE = 8;
+	const static int ENTRY_SIZE = 8;
+};
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+	Read-only DSP tables shared by every plugin instance in the process.
+
+  ==============================================================================
+*/
+
+#include "TableCache.h"
+
+#include <map>
+#include <mutex>
+
+//==============================================================================
+namespace
+{
+	struct Entry
+	{
+		std::weak_ptr<const void> table;
+		size_t bytes = 0;
+	};
+
+	// Function statics, so they exist before any other static that wants a table
+	std::mutex& getMutex()
+	{
+		static std::mutex mutex;
+		return mutex;
+	}
+
+	std::map<std::string, Entry>& getEntries()
+	{
+		static std::map<std::string, Entry> entries;
+		return entries;
+	}
+}
+
+//==============================================================================
+std::shared_ptr<const void> SulfuricTableCache::getOrBuild(const std::string& key, const std::function<Built()>& build)
+{
+	std::lock_guard<std::mutex> lock(getMutex());
+	auto& entry = getEntries()[key];
+
+	if (auto table = entry.table.lock())
+		return table;
+
+	// Building under the lock means two instances starting together still only build it once
+	auto built = build();
+	entry = { built.table, built.bytes };
+	return built.table;
+}
+
+SulfuricTableCache::Statistics SulfuricTableCache::getStatistics()
+{
+	std::lock_guard<std::mutex> lock(getMutex());
+	Statistics statistics;
+
+	for (auto& [key, entry] : getEntries())
+	{
+		if (entry.table.expired())
+			continue;
+
+		++statistics.numTables;
+		statistics.bytes += entry.bytes;
+	}
+
+	return statistics;
+}
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+	Read-only DSP tables shared by every plugin instance in the process.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+//==============================================================================
+/**
+	Each table is built the first time anyone asks for its key and handed out as a
+	shared_ptr to const, so it can't change once built. The cache itself only keeps
+	a weak_ptr: the table is freed when the last holder lets go, and rebuilt if
+	someone asks for it again later.
+
+	Tables need a getMemoryUsage() returning their size in bytes. Put the sample
+	rate or anything else the contents depend on into the key.
+
+	Lookups take a lock, so get tables in constructors or prepareToPlay and hold on
+	to them, never on the audio thread.
+
+	The sine wavetable and the note table are all it holds for now. Envelopes and
+	filters work out their coefficients directly, per segment or control tick.
+*/
+class SulfuricTableCache
+{
+public:
+	template <typename Table, typename Builder>
+	static std::shared_ptr<const Table> get(const std::string& key, Builder&& build)
+	{
+		auto table = getOrBuild(key, [&]() -> Built
+		{
+			auto built = std::make_shared<const Table>(build());
+			return { built, built->getMemoryUsage() };
+		});
+
+		return std::static_pointer_cast<const Table>(table);
+	}
+
+	struct Statistics
+	{
+		// Tables currently alive, each counted once however many instances hold it
+		int numTables = 0;
+		size_t bytes = 0;
+	};
+
+	static Statistics getStatistics();
+
+private:
+	struct Built
+	{
+		std::shared_ptr<const void> table;
+		size_t bytes = 0;
+	};
+
+	static std::shared_ptr<const void> getOrBuild(const std::string& key, const std::function<Built()>& build);
+};
@@ -0,0 +1,726 @@
+/*
+  ==============================================================================
+
+	Structure-of-arrays storage and rendering for every voice of one synth.
+
+  ==============================================================================
+*/
+
+#include "VoiceBank.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <numbers>
+
+//==============================================================================
+SulfuricVoiceBank::SulfuricVoiceBank(int voices)
+	: numVoices(voices),
+	numGroups((voices + SimdFloat::WIDTH - 1) / SimdFloat::WIDTH),
+	wavetable(SulfuricWavetable::getSine())
+{
+	auto padded = (size_t)(numGroups * SimdFloat::WIDTH);
+
+	for (auto* array : { &phase, &phaseIncrement, &tableOffset })
+		array->assign(padded, 0);
+
+	for (auto* array : { &rotationRe, &rotationIm, &level, &envelopeX, &envelopeOffset, &envelopeScale, &filterState1, &filterState2 })
+		array->assign(padded, 0.0f);
+
+	for (auto* array : { &unisonPhase, &unisonPhaseIncrement, &unisonTableOffset })
+		array->assign(padded * MAX_UNISON, 0);
+
+	for (auto* array : { &unisonRotationRe, &unisonRotationIm, &unisonFilterState1, &unisonFilterState2 })
+		array->assign(padded * MAX_UNISON, 0.0f);
+
+	envelopeRatio.assign(padded, 1.0f);
+	envelopeSamplesLeft.assign(padded, INT_MAX);
+	envelopeStage.assign(padded, EnvelopeStage::finished);
+
+	active.assign(padded, 0);
+	releasing.assign(padded, 0);
+	activeInGroup.assign((size_t)numGroups, 0);
+	finishedVoices.reserve((size_t)numVoices);
+	activeGroups.reserve((size_t)numGroups);
+
+	setUnison(unison);
+}
+
+size_t SulfuricVoiceBank::getMemoryUsage() const noexcept
+{
+	auto bytes = sizeof(*this);
+
+	for (auto* array : { &phase, &phaseIncrement, &tableOffset, &unisonPhase, &unisonPhaseIncrement, &unisonTableOffset })
+		bytes += array->capacity() * sizeof(uint32_t);
+
+	for (auto* array : { &rotationRe, &rotationIm, &level, &envelopeX, &envelopeOffset, &envelopeScale, &envelopeRatio, &filterState1, &filterState2,
+		&unisonRotationRe, &unisonRotationIm, &unisonFilterState1, &unisonFilterState2 })
+		bytes += array->capacity() * sizeof(float);
+
+	for (auto* array : { &envelopeSamplesLeft, &activeInGroup, &finishedVoices, &activeGroups })
+		bytes += array->capacity() * sizeof(int);
+
+	return bytes + envelopeStage.capacity() * sizeof(EnvelopeStage) + (active.capacity() + releasing.capacity()) * sizeof(uint8_t);
+}
+
+void SulfuricVoiceBank::setSampleRate(double newSampleRate) noexcept
+{
+	sampleRate = newSampleRate;
+	envelope.prepare(envelope.parameters, sampleRate);
+}
+
+void SulfuricVoiceBank::setEnvelope(const SulfuricEnvelope::Parameters& parameters) noexcept
+{
+	envelope.prepare(parameters, sampleRate);
+
+	for (auto voice = 0; voice < numVoices; ++voice)
+		if (envelopeStage[(size_t)voice] == EnvelopeStage::sustain)
+			enterStage(voice, EnvelopeStage::sustain);
+}
+
+void SulfuricVoiceBank::setQuality(OscillatorQuality newQuality) noexcept
+{
+	// Every quality runs off the same phase, so switching mid-note is seamless
+	quality = newQuality;
+}
+
+void SulfuricVoiceBank::setUnison(const Unison& newUnison) noexcept
+{
+	// The copies sounding voices already have
+	auto numPlaying = unison.voices > 1 ? unison.voices : 0;
+
+	unison = newUnison;
+	unison.voices = std::clamp(unison.voices, 1, MAX_UNISON);
+	unison.detuneCents = std::max(unison.detuneCents, 0.0f);
+	unison.spread = std::clamp(unison.spread, 0.0f, 1.0f);
+
+	// Keeps the loudness about the same however many copies there are, as their phases are unrelated
+	auto amplitude = 1.0f / std::sqrt((float)unison.voices);
+
+	for (auto copy = 0; copy < MAX_UNISON; ++copy)
+	{
+		if (copy >= unison.voices)
+		{
+			unisonRatio[(size_t)copy] = 1.0;
+			unisonLeft[(size_t)copy] = unisonRight[(size_t)copy] = unisonCentre[(size_t)copy] = 0.0f;
+			continue;
+		}
+
+		// -1 for the lowest copy to 1 for the highest
+		auto position = [this](int index) { return unison.voices == 1 ? 0.0f : 2.0f * (float)index / (float)(unison.voices - 1) - 1.0f; };
+		unisonRatio[(size_t)copy] = std::exp2((double)(unison.detuneCents * position(copy)) / 1200.0);
+
+		// Alternately from the left and right edges inwards, so neighbouring pitches land on opposite sides
+		auto panIndex = copy % 2 == 0 ? copy / 2 : unison.voices - 1 - copy / 2;
+		auto pan = unison.spread * position(panIndex);
+
+		unisonLeft[(size_t)copy] = amplitude * std::min(1.0f, 1.0f - pan);
+		unisonRight[(size_t)copy] = amplitude * std::min(1.0f, 1.0f + pan);
+		unisonCentre[(size_t)copy] = 0.5f * (unisonLeft[(size_t)copy] + unisonRight[(size_t)copy]);
+	}
+
+	if (unison.voices == 1)
+		return;
+
+	for (auto voice = 0; voice < numVoices; ++voice)
+		if (active[(size_t)voice])
+			tuneUnison(voice, std::min(numPlaying, unison.voices));
+}
+
+void SulfuricVoiceBank::tuneOscillator(size_t index, uint32_t increment, uint32_t* increments, uint32_t* offsets, float* rotationsRe, float* rotationsIm) const noexcept
+{
+	increments[index] = increment;
+	offsets[index] = (uint32_t)(wavetable->getLevelForIncrement(increment) * SulfuricWavetable::LEVEL_STRIDE);
+
+	// Derive the rotation from the quantised increment so the phasor plays the same pitch as the tables
+	auto angleDelta = (double)increment / 4294967296.0 * 2.0 * std::numbers::pi;
+	rotationsRe[index] = (float)std::cos(angleDelta);
+	rotationsIm[index] = (float)std::sin(angleDelta);
+}
+
+void SulfuricVoiceBank::tuneUnison(int voice, int numAlreadyPlaying) noexcept
+{
+	auto v = (size_t)voice;
+
+	for (auto copy = 0; copy < unison.voices; ++copy)
+	{
+		auto index = v * MAX_UNISON + (size_t)copy;
+
+		if (copy >= numAlreadyPlaying)
+		{
+			// Spread by the golden ratio, copies all starting in phase would add up to one loud blip
+			unisonPhase[index] = phase[v] + (uint32_t)copy * 0x9e3779b9u;
+			unisonFilterState1[index] = 0.0f;
+			unisonFilterState2[index] = 0.0f;
+		}
+
+		auto increment = std::min((double)UINT32_MAX, std::round((double)phaseIncrement[v] * unisonRatio[(size_t)copy]));
+		tuneOscillator(index, (uint32_t)increment, unisonPhaseIncrement.data(), unisonTableOffset.data(), unisonRotationRe.data(), unisonRotationIm.data());
+	}
+}
+
+void SulfuricVoiceBank::startVoice(int voice, double frequency, float velocity) noexcept
+{
+	auto v = (size_t)voice;
+
+	if (!active[v])
+	{
+		active[v] = 1;
+		++activeInGroup[v / SimdFloat::WIDTH];
+		++numActive;
+	}
+
+	phase[v] = 0;
+	tuneOscillator(v, SulfuricWavetable::incrementForFrequency(frequency, sampleRate), phaseIncrement.data(), tableOffset.data(), rotationRe.data(), rotationIm.data());
+
+	// A stolen voice starts from silence too
+	filterState1[v] = 0.0f;
+	filterState2[v] = 0.0f;
+
+	if (unison.voices > 1)
+		tuneUnison(voice, 0);
+
+	level[v] = velocity;
+	releasing[v] = 0;
+	enterStage(voice, EnvelopeStage::attack);
+}
+
+void SulfuricVoiceBank::stopVoice(int voice, bool allowTailOff) noexcept
+{
+	auto v = (size_t)voice;
+
+	if (!active[v])
+		return;
+
+	if (!allowTailOff)
+	{
+		deactivate(voice);
+		return;
+	}
+
+	if (!releasing[v])
+	{
+		releasing[v] = 1;
+		enterStage(voice, EnvelopeStage::release);
+	}
+}
+
+void SulfuricVoiceBank::enterStage(int voice, EnvelopeStage stage) noexcept
+{
+	auto v = (size_t)voice;
+	const SulfuricEnvelope::Segment* segment = nullptr;
+
+	// Every segment starts with x at 1
+	auto offset = 0.0f, scale = 0.0f;
+
+	switch (stage)
+	{
+	case EnvelopeStage::attack:
+		// 0 up to the velocity
+		segment = &envelope.attack;
+		offset = level[v];
+		scale = -level[v];
+		break;
+	case EnvelopeStage::decay:
+		// The velocity down to the sustain level
+		segment = &envelope.decay;
+		offset = level[v] * envelope.parameters.sustainLevel;
+		scale = level[v] - offset;
+		break;
+	case EnvelopeStage::sustain:
+		offset = level[v] * envelope.parameters.sustainLevel;
+		break;
+	case EnvelopeStage::release:
+		// Wherever the envelope got to, down to 0
+		segment = &envelope.release;
+		scale = envelopeOffset[v] + envelopeScale[v] * envelopeX[v];
+		break;
+	case EnvelopeStage::finished:
+		break;
+	}
+
+	if (segment != nullptr && segment->length == 0)
+	{
+		// Jump to the end of a zero length segment, where x has reached 0
+		envelopeOffset[v] = offset;
+		envelopeScale[v] = 0.0f;
+		envelopeX[v] = 0.0f;
+		enterStage(voice, getNextStage(stage));
+		return;
+	}
+
+	envelopeStage[v] = stage;
+	envelopeOffset[v] = offset;
+	envelopeScale[v] = scale;
+
+	if (segment != nullptr)
+	{
+		envelopeX[v] = 1.0f;
+		envelopeRatio[v] = segment->ratio;
+		envelopeSamplesLeft[v] = segment->length;
+	}
+	else
+	{
+		// Sustain and finished hold still until something else happens
+		envelopeX[v] = 0.0f;
+		envelopeRatio[v] = 1.0f;
+		envelopeSamplesLeft[v] = INT_MAX;
+	}
+}
+
+SulfuricVoiceBank::EnvelopeStage SulfuricVoiceBank::getNextStage(EnvelopeStage stage) noexcept
+{
+	switch (stage)
+	{
+	case EnvelopeStage::attack:
+		return EnvelopeStage::decay;
+	case EnvelopeStage::decay:
+		return EnvelopeStage::sustain;
+	case EnvelopeStage::release:
+		return EnvelopeStage::finished;
+	default:
+		return stage;
+	}
+}
+
+void SulfuricVoiceBank::deactivate(int voice) noexcept
+{
+	auto v = (size_t)voice;
+
+	active[v] = 0;
+	releasing[v] = 0;
+	--activeInGroup[v / SimdFloat::WIDTH];
+	--numActive;
+
+	// Idle lanes still run through the kernel with their group, make sure they add nothing
+	level[v] = 0.0f;
+	enterStage(voice, EnvelopeStage::finished);
+	phaseIncrement[v] = 0;
+	filterState1[v] = 0.0f;
+	filterState2[v] = 0.0f;
+}
+
+//==============================================================================
+void SulfuricVoiceBank::render(float* output, int numSamples) noexcept
+{
+	renderGroups(output, nullptr, numSamples, 0, beginRender(), scratch);
+	finishRender();
+}
+
+void SulfuricVoiceBank::render(float* left, float* right, int numSamples) noexcept
+{
+	renderGroups(left, right, numSamples, 0, beginRender(), scratch);
+	finishRender();
+}
+
+int SulfuricVoiceBank::beginRender() noexcept
+{
+	finishedVoices.clear();
+	activeGroups.clear();
+
+	for (auto group = 0; group < numGroups; ++group)
+		if (activeInGroup[(size_t)group] > 0)
+			activeGroups.push_back(group);
+
+	return (int)activeGroups.size();
+}
+
+void SulfuricVoiceBank::renderGroups(float* left, float* right, int numSamples, int first, int last, Scratch& scratch) noexcept
+{
+	if (first >= last)
+		return;
+
+	// Otherwise everything is mixed into scratch.left, and added to both channels
+	const auto isStereoMix = right != nullptr && isStereo();
+
+	// Only the groups' own lanes get written, which is what lets other threads render other groups meanwhile
+	while (numSamples > 0)
+	{
+		auto chunkSize = std::min(numSamples, RENDER_CHUNK);
+
+		for (auto i = 0; i < chunkSize; ++i)
+			scratch.left[i] = SimdFloat::broadcast(0.0f);
+
+		if (isStereoMix)
+			for (auto i = 0; i < chunkSize; ++i)
+				scratch.right[i] = SimdFloat::broadcast(0.0f);
+
+		for (auto index = first; index < last; ++index)
+		{
+			auto firstVoice = activeGroups[(size_t)index] * SimdFloat::WIDTH;
+
+			switch (quality)
+			{
+			case OscillatorQuality::exact:
+				renderGroup<OscillatorQuality::exact>(firstVoice, chunkSize, isStereoMix, scratch);
+				break;
+			case OscillatorQuality::phasor:
+				renderGroup<OscillatorQuality::phasor>(firstVoice, chunkSize, isStereoMix, scratch);
+				break;
+			case OscillatorQuality::cubic:
+				renderGroup<OscillatorQuality::cubic>(firstVoice, chunkSize, isStereoMix, scratch);
+				break;
+			case OscillatorQuality::linear:
+				renderGroup<OscillatorQuality::linear>(firstVoice, chunkSize, isStereoMix, scratch);
+				break;
+			}
+		}
+
+		if (isStereoMix)
+		{
+			for (auto i = 0; i < chunkSize; ++i)
+			{
+				left[i] += scratch.left[i].sum();
+				right[i] += scratch.right[i].sum();
+			}
+		}
+		else
+		{
+			for (auto i = 0; i < chunkSize; ++i)
+			{
+				auto sample = scratch.left[i].sum();
+				left[i] += sample;
+
+				if (right != nullptr)
+					right[i] += sample;
+			}
+		}
+
+		left += chunkSize;
+		if (right != nullptr)
+			right += chunkSize;
+
+		numSamples -= chunkSize;
+	}
+}
+
+void SulfuricVoiceBank::finishRender() noexcept
+{
+	// A voice that finished part way through kept rendering with a gain of exactly 0, so retiring it now changes nothing
+	for (auto group : activeGroups)
+	{
+		for (auto voice = group * SimdFloat::WIDTH; voice < std::min(numVoices, (group + 1) * SimdFloat::WIDTH); ++voice)
+		{
+			if (active[(size_t)voice] && envelopeStage[(size_t)voice] == EnvelopeStage::finished)
+			{
+				deactivate(voice);
+				finishedVoices.push_back(voice);
+			}
+		}
+	}
+}
+
+void SulfuricVoiceBank::renderEnvelopes(int firstVoice, int numSamples, SimdFloat* gain) noexcept
+{
+	const auto first = (size_t)firstVoice;
+
+	for (auto position = 0; position < numSamples;)
+	{
+		// Up to the next segment boundary in any lane
+		auto n = numSamples - position;
+		for (auto v = first; v < first + SimdFloat::WIDTH; ++v)
+			n = std::min(n, envelopeSamplesLeft[v]);
+
+		const auto offset = SimdFloat::load(&envelopeOffset[first]);
+		const auto scale = SimdFloat::load(&envelopeScale[first]);
+		const auto ratio = SimdFloat::load(&envelopeRatio[first]);
+
+		// x * ratio^i as four interleaved chains, so consecutive multiplies don't wait on each other
+		const auto ratio2 = ratio * ratio;
+		const auto ratio4 = ratio2 * ratio2;
+
+		auto x0 = SimdFloat::load(&envelopeX[first]);
+		auto x1 = x0 * ratio, x2 = x0 * ratio2, x3 = x1 * ratio2;
+		auto* out = gain + position;
+
+		auto i = 0;
+		for (; i + 4 <= n; i += 4)
+		{
+			out[i] = offset + scale * x0;
+			out[i + 1] = offset + scale * x1;
+			out[i + 2] = offset + scale * x2;
+			out[i + 3] = offset + scale * x3;
+
+			x0 = x0 * ratio4;
+			x1 = x1 * ratio4;
+			x2 = x2 * ratio4;
+			x3 = x3 * ratio4;
+		}
+
+		for (; i < n; ++i)
+		{
+			out[i] = offset + scale * x0;
+			x0 = x0 * ratio;
+		}
+
+		x0.store(&envelopeX[first]);
+
+		for (auto v = first; v < first + SimdFloat::WIDTH; ++v)
+		{
+			// Sustain and finished never run out
+			if (envelopeSamplesLeft[v] == INT_MAX)
+				continue;
+
+			envelopeSamplesLeft[v] -= n;
+
+			if (envelopeSamplesLeft[v] == 0)
+				enterStage((int)v, getNextStage(envelopeStage[v]));
+		}
+
+		position += n;
+	}
+}
+
+template <OscillatorQuality oscillatorQuality>
+void SulfuricVoiceBank::renderGroup(int firstVoice, int numSamples, bool isStereoMix, Scratch& scratch) noexcept
+{
+	const auto isFiltered = filter.mode != SulfuricFilter::Mode::off;
+
+	if (unison.voices == 1)
+	{
+		if (isFiltered)
+			renderGroup<oscillatorQuality, true>(firstVoice, numSamples, scratch);
+		else
+			renderGroup<oscillatorQuality, false>(firstVoice, numSamples, scratch);
+	}
+	else if (isStereoMix)
+	{
+		if (isFiltered)
+			renderUnisonGroup<oscillatorQuality, true, true>(firstVoice, numSamples, scratch);
+		else
+			renderUnisonGroup<oscillatorQuality, false, true>(firstVoice, numSamples, scratch);
+	}
+	else
+	{
+		if (isFiltered)
+			renderUnisonGroup<oscillatorQuality, true, false>(firstVoice, numSamples, scratch);
+		else
+			renderUnisonGroup<oscillatorQuality, false, false>(firstVoice, numSamples, scratch);
+	}
+}
+
+template <OscillatorQuality oscillatorQuality, bool isFiltered>
+void SulfuricVoiceBank::renderGroup(int firstVoice, int numSamples, Scratch& scratch) noexcept
+{
+	const auto first = (size_t)firstVoice;
+	auto* mix = scratch.left;
+	const auto* gain = scratch.gain;
+
+	renderEnvelopes(firstVoice, numSamples, scratch.gain);
+
+	// Once per chunk, each lane's cutoff moves with where its envelope is at the start of the chunk
+	SulfuricFilter::Coefficients coefficients{};
+	SimdFloat filter1{}, filter2{};
+
+	if constexpr (isFiltered)
+	{
+		alignas(32) float envelopeLevel[SimdFloat::WIDTH], filterGain[SimdFloat::WIDTH];
+		gain[0].store(envelopeLevel);
+
+		for (auto lane = 0; lane < SimdFloat::WIDTH; ++lane)
+			filterGain[lane] = getFilterGain(envelopeLevel[lane]);
+
+		coefficients = SulfuricFilter::makeCoefficients(filter, filterGain);
+		filter1 = SimdFloat::load(&filterState1[first]);
+		filter2 = SimdFloat::load(&filterState2[first]);
+	}
+
+	// Renders one sample of every lane from osc, through the filter and the envelope
+	auto accumulate = [&](int i, SimdFloat osc) noexcept
+	{
+		if constexpr (isFiltered)
+			osc = SulfuricFilter::process(osc, coefficients, filter1, filter2);
+
+		mix[i] = mix[i] + osc * gain[i];
+	};
+
+	renderOscillators<oscillatorQuality>({ &phase[first], &phaseIncrement[first], &tableOffset[first], &rotationRe[first], &rotationIm[first] }, numSamples, accumulate);
+
+	if constexpr (isFiltered)
+	{
+		filter1.store(&filterState1[first]);
+		filter2.store(&filterState2[first]);
+	}
+}
+
+template <OscillatorQuality oscillatorQuality, bool isFiltered, bool isStereoMix>
+void SulfuricVoiceBank::renderUnisonGroup(int firstVoice, int numSamples, Scratch& scratch) noexcept
+{
+	const auto first = (size_t)firstVoice;
+	auto* voiceLeft = scratch.voiceLeft;
+	auto* voiceRight = scratch.voiceRight;
+
+	// The envelopes still run a lane per voice, each voice's copies then share its lane
+	renderEnvelopes(firstVoice, numSamples, scratch.gain);
+
+	for (auto i = 0; i < numSamples; ++i)
+		scratch.gain[i].store(scratch.voiceGain + i * SimdFloat::WIDTH);
+
+	const auto numBatches = (unison.voices + SimdFloat::WIDTH - 1) / SimdFloat::WIDTH;
+
+	for (auto lane = 0; lane < SimdFloat::WIDTH; ++lane)
+	{
+		const auto v = first + (size_t)lane;
+		if (!active[v])
+			continue;
+
+		const auto* voiceGain = scratch.voiceGain + lane;
+
+		// The voice's own oscillator keeps time, so copies added later start from where it is
+		phase[v] += phaseIncrement[v] * (uint32_t)numSamples;
+
+		// Every copy follows the voice's envelope, so they all share one cutoff
+		SulfuricFilter::Coefficients coefficients{};
+
+		if constexpr (isFiltered)
+		{
+			alignas(32) float filterGain[SimdFloat::WIDTH];
+			std::fill(filterGain, filterGain + SimdFloat::WIDTH, getFilterGain(voiceGain[0]));
+			coefficients = SulfuricFilter::makeCoefficients(filter, filterGain);
+		}
+
+		// The copies are summed first, so the envelope costs one multiply per voice, not per copy
+		for (auto i = 0; i < numSamples; ++i)
+			voiceLeft[i] = SimdFloat::broadcast(0.0f);
+
+		if constexpr (isStereoMix)
+			for (auto i = 0; i < numSamples; ++i)
+				voiceRight[i] = SimdFloat::broadcast(0.0f);
+
+		for (auto batch = 0; batch < numBatches; ++batch)
+		{
+			const auto copy = (size_t)(batch * SimdFloat::WIDTH);
+			const auto index = v * MAX_UNISON + copy;
+
+			// Folded down to mono the copies all sit in the centre
+			const auto toLeft = SimdFloat::load(isStereoMix ? &unisonLeft[copy] : &unisonCentre[copy]);
+			const auto toRight = SimdFloat::load(&unisonRight[copy]);
+
+			SimdFloat filter1{}, filter2{};
+
+			if constexpr (isFiltered)
+			{
+				filter1 = SimdFloat::load(&unisonFilterState1[index]);
+				filter2 = SimdFloat::load(&unisonFilterState2[index]);
+			}
+
+			auto accumulate = [&](int i, SimdFloat osc) noexcept
+			{
+				if constexpr (isFiltered)
+					osc = SulfuricFilter::process(osc, coefficients, filter1, filter2);
+
+				voiceLeft[i] = voiceLeft[i] + osc * toLeft;
+
+				if constexpr (isStereoMix)
+					voiceRight[i] = voiceRight[i] + osc * toRight;
+			};
+
+			renderOscillators<oscillatorQuality>({ &unisonPhase[index], &unisonPhaseIncrement[index], &unisonTableOffset[index], &unisonRotationRe[index], &unisonRotationIm[index] },
+				numSamples, accumulate);
+
+			if constexpr (isFiltered)
+			{
+				filter1.store(&unisonFilterState1[index]);
+				filter2.store(&unisonFilterState2[index]);
+			}
+		}
+
+		for (auto i = 0; i < numSamples; ++i)
+		{
+			auto gain = SimdFloat::broadcast(voiceGain[i * SimdFloat::WIDTH]);
+			scratch.left[i] = scratch.left[i] + voiceLeft[i] * gain;
+
+			if constexpr (isStereoMix)
+				scratch.right[i] = scratch.right[i] + voiceRight[i] * gain;
+		}
+	}
+}
+
+template <OscillatorQuality oscillatorQuality, typename Accumulate>
+void SulfuricVoiceBank::renderOscillators(const OscillatorLanes& lanes, int numSamples, Accumulate&& accumulate) const noexcept
+{
+	auto p = SimdInt::load(lanes.phase);
+	const auto increment = SimdInt::load(lanes.phaseIncrement);
+
+	if constexpr (oscillatorQuality == OscillatorQuality::exact)
+	{
+		alignas(32) float osc[SimdFloat::WIDTH];
+		alignas(32) uint32_t lanePhase[SimdFloat::WIDTH];
+
+		for (auto i = 0; i < numSamples; ++i)
+		{
+			p.store(lanePhase);
+			for (auto lane = 0; lane < SimdFloat::WIDTH; ++lane)
+				osc[lane] = (float)std::sin((double)lanePhase[lane] * (2.0 * std::numbers::pi / 4294967296.0));
+
+			accumulate(i, SimdFloat::load(osc));
+			p = p + increment;
+		}
+	}
+	else if constexpr (oscillatorQuality == OscillatorQuality::phasor)
+	{
+		// Re-seed from the exact phase every chunk, so float rounding never gets to accumulate
+		alignas(32) float seedRe[SimdFloat::WIDTH], seedIm[SimdFloat::WIDTH];
+
+		for (auto lane = 0; lane < SimdFloat::WIDTH; ++lane)
+		{
+			auto angle = (double)lanes.phase[lane] * (2.0 * std::numbers::pi / 4294967296.0);
+			seedRe[lane] = (float)std::cos(angle);
+			seedIm[lane] = (float)std::sin(angle);
+		}
+
+		auto r = SimdFloat::load(seedRe);
+		auto i = SimdFloat::load(seedIm);
+		const auto rotRe = SimdFloat::load(lanes.rotationRe);
+		const auto rotIm = SimdFloat::load(lanes.rotationIm);
+
+		for (auto n = 0; n < numSamples; ++n)
+		{
+			accumulate(n, i);
+
+			auto nextRe = r * rotRe - i * rotIm;
+			i = r * rotIm + i * rotRe;
+			r = nextRe;
+		}
+
+		for (auto lane = 0; lane < SimdFloat::WIDTH; ++lane)
+			lanes.phase[lane] += lanes.phaseIncrement[lane] * (uint32_t)numSamples;
+
+		p = SimdInt::load(lanes.phase);
+	}
+	else
+	{
+		// Gathering from one sample before the cycle keeps every index positive
+		const auto* base = wavetable->getLevel(0) - 1;
+		const auto levelOffset = SimdInt::load(lanes.tableOffset);
+		const auto fractionMask = SimdInt::broadcast(SulfuricWavetable::FRACTION_MASK);
+		const auto fractionScale = SimdFloat::broadcast(1.0f / (float)(1u << SulfuricWavetable::FRACTION_BITS));
+
+		for (auto n = 0; n < numSamples; ++n)
+		{
+			auto index = p.shiftRight<SulfuricWavetable::FRACTION_BITS>() + levelOffset;
+			auto t = (p & fractionMask).toFloat() * fractionScale;
+
+			SimdFloat y0, y1, y2, y3;
+			SimdInt::gather4(base, index, y0, y1, y2, y3);
+
+			if constexpr (oscillatorQuality == OscillatorQuality::cubic)
+			{
+				// Same Hermite as SulfuricWavetable::readCubic
+				auto half = SimdFloat::broadcast(0.5f);
+				auto c1 = half * (y2 - y0);
+				auto c2 = y0 - SimdFloat::broadcast(2.5f) * y1 + SimdFloat::broadcast(2.0f) * y2 - half * y3;
+				auto c3 = half * (y3 - y0) + SimdFloat::broadcast(1.5f) * (y1 - y2);
+				accumulate(n, ((c3 * t + c2) * t + c1) * t + y1);
+			}
+			else
+			{
+				accumulate(n, y1 + t * (y2 - y1));
+			}
+
+			p = p + increment;
+		}
+	}
+
+	p.store(lanes.phase);
+}
@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+
+	Structure-of-arrays storage and rendering for every voice of one synth.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Envelope.h"
+#include "Filter.h"
+#include "Oscillator.h"
+#include "Simd.h"
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+//==============================================================================
+/**
+	Holds the oscillator, filter and envelope state of all voices in contiguous arrays
+	and renders SimdFloat::WIDTH voices at once, one voice per lane.
+
+	In unison a voice plays up to MAX_UNISON detuned copies of its oscillator instead,
+	spread across the stereo field. They are rendered SimdFloat::WIDTH copies at once,
+	one copy per lane, all under the voice's single envelope.
+
+	Voices are identified by index. The bank knows nothing about notes or MIDI,
+	that is SulfuricVoiceEngine's job.
+*/
+class SulfuricVoiceBank
+{
+public:
+	explicit SulfuricVoiceBank(int numVoices);
+
+	int getNumVoices() const noexcept { return numVoices; }
+	int getNumActiveVoices() const noexcept { return numActive; }
+
+	/** Recomputes the envelope segments too, so call it off the audio thread or between blocks. */
+	void setSampleRate(double) noexcept;
+
+	/** Sounding voices pick the new times up at their next segment, sustaining voices move to the new level straight away. */
+	void setEnvelope(const SulfuricEnvelope::Parameters&) noexcept;
+	const SulfuricEnvelope::Parameters& getEnvelope() const noexcept { return envelope.parameters; }
+
+	void setQuality(OscillatorQuality) noexcept;
+	OscillatorQuality getQuality() const noexcept { return quality; }
+
+	/** Sounding voices keep their filter state, so changing this mid-note doesn't click. */
+	void setFilter(const SulfuricFilter::Parameters& parameters) noexcept { filter = parameters; }
+	const SulfuricFilter::Parameters& getFilter() const noexcept { return filter; }
+
+	constexpr static int MAX_UNISON = 16;
+
+	struct Unison
+	{
+		// 1 is a single oscillator per voice, the usual render path
+		int voices = 1;
+
+		// The outermost copies are this far above and below the voice's pitch, the rest evenly in between
+		float detuneCents = 20.0f;
+
+		// 0 keeps every copy in the centre, 1 pans the outermost ones hard left and right
+		float spread = 1.0f;
+
+		bool operator==(const Unison&) const = default;
+	};
+
+	/** Sounding voices keep their copies' phases and retune them, adding or dropping copies as needed. */
+	void setUnison(const Unison&) noexcept;
+	const Unison& getUnison() const noexcept { return unison; }
+
+	/** Whether the left and right outputs can differ, otherwise rendering into one channel is enough. */
+	bool isStereo() const noexcept { return unison.voices > 1 && unison.spread > 0.0f; }
+
+	/** Restarts a voice at phase 0 from the start of its attack. */
+	void startVoice(int voice, double frequency, float velocity) noexcept;
+
+	/** Starts the release tail, or silences the voice straight away. */
+	void stopVoice(int voice, bool allowTailOff) noexcept;
+
+	bool isVoiceActive(int voice) const noexcept { return active[(size_t)voice] != 0; }
+	bool isVoiceReleasing(int voice) const noexcept { return releasing[(size_t)voice] != 0; }
+
+	/** Where the voice's envelope has got to, velocity included. */
+	float getVoiceGain(int voice) const noexcept
+	{
+		auto v = (size_t)voice;
+		return envelopeOffset[v] + envelopeScale[v] * envelopeX[v];
+	}
+
+	/** How long a released voice keeps sounding. */
+	int getReleaseLengthInSamples() const noexcept { return envelope.release.length; }
+
+	// Voices render this many samples at a time. It is also the filter's control rate, each voice's cutoff follows its envelope once a chunk.
+	constexpr static int RENDER_CHUNK = 64;
+
+	/** Working space for rendering, one per thread that renders at the same time. */
+	struct Scratch
+	{
+		// Only left is used while every voice is in the centre
+		SimdFloat left[RENDER_CHUNK], right[RENDER_CHUNK], gain[RENDER_CHUNK];
+
+		// In unison, one voice's copies before its envelope, and the group's envelopes a voice at a time
+		SimdFloat voiceLeft[RENDER_CHUNK], voiceRight[RENDER_CHUNK];
+		alignas(32) float voiceGain[RENDER_CHUNK * SimdFloat::WIDTH];
+	};
+
+	/** Adds the mono sum of every active voice into output. A spread unison is folded down, the average of left and right. */
+	void render(float* output, int numSamples) noexcept;
+
+	/** Adds every active voice into left and right. */
+	void render(float* left, float* right, int numSamples) noexcept;
+
+	/**
+		render() in three steps, so the groups of SimdFloat::WIDTH voices can be shared between threads.
+
+		beginRender() lists the groups with a voice sounding and returns how many there are. renderGroups()
+		then adds the groups numbered first to last - 1 in that list into left and right, or their mono sum
+		into left if right is nullptr. It can run on several threads at once as long as each has its own
+		Scratch and groups. finishRender() retires the voices that ran out, once every group has rendered.
+	*/
+	int beginRender() noexcept;
+	void renderGroups(float* left, float* right, int numSamples, int first, int last, Scratch&) noexcept;
+	void finishRender() noexcept;
+
+	/** The voices whose release ran out during the last call to render() or finishRender(). */
+	const std::vector<int>& getFinishedVoices() const noexcept { return finishedVoices; }
+
+	/** Bytes this bank owns, not counting the shared wavetable. */
+	size_t getMemoryUsage() const noexcept;
+
+private:
+	enum class EnvelopeStage : uint8_t { attack, decay, sustain, release, finished };
+
+	template <OscillatorQuality, bool isFiltered>
+	void renderGroup(int firstVoice, int numSamples, Scratch&) noexcept;
+
+	template <OscillatorQuality, bool isFiltered, bool isStereoMix>
+	void renderUnisonGroup(int firstVoice, int numSamples, Scratch&) noexcept;
+
+	template <OscillatorQuality>
+	void renderGroup(int firstVoice, int numSamples, bool isStereoMix, Scratch&) noexcept;
+
+	/** SimdFloat::WIDTH oscillators side by side in the arrays, starting at the pointers. */
+	struct OscillatorLanes
+	{
+		uint32_t* phase;
+		const uint32_t* phaseIncrement;
+		const uint32_t* tableOffset;
+		const float* rotationRe;
+		const float* rotationIm;
+	};
+
+	/** Calls accumulate(i, osc) for each of numSamples samples of every lane, moving the phases on. */
+	template <OscillatorQuality, typename Accumulate>
+	void renderOscillators(const OscillatorLanes&, int numSamples, Accumulate&&) const noexcept;
+
+	/** Sets one oscillator of the arrays playing at increment, phase untouched. */
+	void tuneOscillator(size_t index, uint32_t increment, uint32_t* increments, uint32_t* offsets, float* rotationsRe, float* rotationsIm) const noexcept;
+
+	/** Tunes a voice's unison copies around its own pitch, starting those that weren't playing yet. */
+	void tuneUnison(int voice, int numAlreadyPlaying) noexcept;
+
+	/** The filter's gain for the cutoff an envelope of level puts it at. */
+	float getFilterGain(float level) const noexcept
+	{
+		return SulfuricFilter::getGain(filter.cutoffHz * std::exp2(filter.envelopeOctaves * level), sampleRate);
+	}
+
+	/** Fills gain with the envelope of every lane in the group, velocity included, moving on through the segments. */
+	void renderEnvelopes(int firstVoice, int numSamples, SimdFloat* gain) noexcept;
+
+	/** Starts a segment from the voice's current gain, skipping straight through any that are 0 samples long. */
+	void enterStage(int voice, EnvelopeStage) noexcept;
+	static EnvelopeStage getNextStage(EnvelopeStage) noexcept;
+
+	void deactivate(int voice) noexcept;
+
+	int numVoices, numGroups, numActive = 0;
+	double sampleRate = 44100.0;
+	OscillatorQuality quality = OscillatorQuality::cubic;
+	SulfuricEnvelope envelope;
+	SulfuricFilter::Parameters filter;
+	Unison unison;
+
+	// Shared with every other bank in the process
+	std::shared_ptr<const SulfuricWavetable> wavetable;
+
+	// One entry per voice, padded to a whole number of SIMD groups.
+	// phase is the canonical oscillator position for every quality.
+	std::vector<uint32_t> phase, phaseIncrement, tableOffset;
+
+	// The phasor rotates by (rotationRe, rotationIm) every sample, re-seeded from phase every chunk
+	std::vector<float> rotationRe, rotationIm;
+
+	// The gain is offset + scale * x with x *= ratio every sample, see SulfuricEnvelope::Segment.
+	// offset and scale have the velocity in them.
+	std::vector<float> level, envelopeX, envelopeOffset, envelopeScale, envelopeRatio;
+
+	// The filter's two integrators
+	std::vector<float> filterState1, filterState2;
+
+	// MAX_UNISON copies per voice, voice * MAX_UNISON onwards, each with its own oscillator and filter.
+	// They only move while the voice is in unison.
+	std::vector<uint32_t> unisonPhase, unisonPhaseIncrement, unisonTableOffset;
+	std::vector<float> unisonRotationRe, unisonRotationIm, unisonFilterState1, unisonFilterState2;
+
+	// Per copy, the same for every voice: its pitch relative to the voice's and its gains into each channel.
+	// Copies beyond unison.voices have all gains at 0.
+	std::array<double, MAX_UNISON> unisonRatio;
+	alignas(32) std::array<float, MAX_UNISON> unisonLeft, unisonRight, unisonCentre;
+	std::vector<int> envelopeSamplesLeft;
+	std::vector<EnvelopeStage> envelopeStage;
+
+	std::vector<uint8_t> active, releasing;
+	std::vector<int> activeInGroup;
+
+	// Reserved for every voice and group up front, so rendering never allocates
+	std::vector<int> finishedVoices, activeGroups;
+
+	// For render(), on whichever thread calls it
+	Scratch scratch;
+};
@@ -0,0 +1,575 @@
+/*
+  ==============================================================================
+
+	Turns MIDI into voice starts and stops, and renders the voice bank.
+
+  ==============================================================================
+*/
+
+#include "VoiceEngine.h"
+#include "RealtimeAudit.h"
+
+#include <algorithm>
+
+//==============================================================================
+namespace
+{
+	/** Adds mono into numChannels channels, converting each sample once however many channels there are. */
+	template <typename SampleType, int numChannels>
+	void addToChannels(SampleType* const* channels, int startSample, const float* mono, int numSamples) noexcept
+	{
+		if constexpr (std::is_same_v<SampleType, float> && numChannels == 1)
+		{
+			juce::FloatVectorOperations::add(channels[0] + startSample, mono, numSamples);
+		}
+		else
+		{
+			SampleType* out[numChannels];
+			for (auto channel = 0; channel < numChannels; ++channel)
+				out[channel] = channels[channel] + startSample;
+
+			for (auto i = 0; i < numSamples; ++i)
+			{
+				auto sample = (SampleType)mono[i];
+				for (auto channel = 0; channel < numChannels; ++channel)
+					out[channel][i] += sample;
+			}
+		}
+	}
+
+	template <typename SampleType>
+	void addToChannels(juce::AudioBuffer<SampleType>& buffer, int startSample, const float* mono, int numSamples) noexcept
+	{
+		auto* const* channels = buffer.getArrayOfWritePointers();
+
+		switch (buffer.getNumChannels())
+		{
+		case 1:
+			addToChannels<SampleType, 1>(channels, startSample, mono, numSamples);
+			break;
+		case 2:
+			addToChannels<SampleType, 2>(channels, startSample, mono, numSamples);
+			break;
+		default:
+			for (auto channel = 0; channel < buffer.getNumChannels(); ++channel)
+				addToChannels<SampleType, 1>(channels + channel, startSample, mono, numSamples);
+			break;
+		}
+	}
+
+	/** Adds left and right into the first two channels, and carries on alternating between them for any more. */
+	template <typename SampleType>
+	void addToChannels(juce::AudioBuffer<SampleType>& buffer, int startSample, const float* left, const float* right, int numSamples) noexcept
+	{
+		if (right == nullptr)
+		{
+			addToChannels(buffer, startSample, left, numSamples);
+			return;
+		}
+
+		auto* const* channels = buffer.getArrayOfWritePointers();
+
+		for (auto channel = 0; channel < buffer.getNumChannels(); ++channel)
+			addToChannels<SampleType, 1>(channels + channel, startSample, channel % 2 == 0 ? left : right, numSamples);
+	}
+}
+
+//==============================================================================
+SulfuricVoiceEngine::SulfuricVoiceEngine(int maxVoices)
+	: bank(maxVoices),
+	notes(SulfuricNoteTable::getShared()),
+	polyphony(maxVoices),
+	voiceKey((size_t)maxVoices, -1),
+	nextVoice((size_t)maxVoices, -1),
+	previousVoice((size_t)maxVoices, -1),
+	voiceState((size_t)maxVoices, VoiceState::free),
+	voiceKeyDown((size_t)maxVoices, 0)
+{
+	// Lowest voice on top, so voices fill the first SIMD groups first
+	freeVoices.reserve((size_t)maxVoices);
+	for (auto voice = maxVoices; --voice >= 0;)
+		freeVoices.push_back(voice);
+
+	heldScratch.reserve((size_t)maxVoices);
+
+	keyVoices.fill(-1);
+}
+
+size_t SulfuricVoiceEngine::getMemoryUsage() const noexcept
+{
+	auto bytes = sizeof(*this) - sizeof(bank) + bank.getMemoryUsage();
+
+	for (auto* array : { &voiceKey, &nextVoice, &previousVoice, &freeVoices, &heldScratch })
+		bytes += array->capacity() * sizeof(int);
+
+	bytes += voiceState.capacity() * sizeof(VoiceState) + voiceKeyDown.capacity() * sizeof(uint8_t);
+	return bytes + threadScratch.capacity() * sizeof(SulfuricVoiceBank::Scratch) + jobOutput.capacity() * sizeof(float);
+}
+
+void SulfuricVoiceEngine::setWorkerPool(SulfuricWorkerPool* pool)
+{
+	workerPool = pool;
+
+	if (pool == nullptr)
+	{
+		threadScratch.clear();
+		jobOutput.clear();
+		return;
+	}
+
+	auto maxGroups = (getNumVoices() + SimdFloat::WIDTH - 1) / SimdFloat::WIDTH;
+	auto maxJobs = (maxGroups + GROUPS_PER_JOB - 1) / GROUPS_PER_JOB;
+
+	threadScratch.resize((size_t)pool->getNumThreads());
+	jobOutput.assign((size_t)(maxJobs * 2 * PARALLEL_CHUNK), 0.0f);
+}
+
+void SulfuricVoiceEngine::setCurrentPlaybackSampleRate(double sampleRate)
+{
+	allNotesOff(0, false);
+	bank.setSampleRate(sampleRate);
+}
+
+void SulfuricVoiceEngine::setQuality(OscillatorQuality quality)
+{
+	bank.setQuality(quality);
+}
+
+void SulfuricVoiceEngine::setPolyphony(int newPolyphony) noexcept
+{
+	polyphony = juce::jlimit(1, bank.getNumVoices(), newPolyphony);
+}
+
+void SulfuricVoiceEngine::setControlInterval(int numSamples) noexcept
+{
+	controlInterval = juce::jmax(1, numSamples);
+}
+
+//==============================================================================
+template <typename SampleType>
+bool SulfuricVoiceEngine::renderNextBlock(juce::AudioBuffer<SampleType>& outputAudio, const juce::MidiBuffer& midiData, int startSample, int numSamples, int midiChannel)
+{
+	SULFURIC_REALTIME_SCOPE();
+	return renderEvents(outputAudio, midiData, startSample, numSamples, midiChannel);
+}
+
+template <typename SampleType>
+bool SulfuricVoiceEngine::renderNextBlock(juce::AudioBuffer<SampleType>& outputAudio, const SulfuricMidiRouter::BusEvents& events, int startSample, int numSamples)
+{
+	SULFURIC_REALTIME_SCOPE();
+	return renderEvents(outputAudio, events, startSample, numSamples, 0);
+}
+
+template <typename SampleType, typename Events>
+bool SulfuricVoiceEngine::renderEvents(juce::AudioBuffer<SampleType>& outputAudio, const Events& events, int startSample, int numSamples, int midiChannel)
+{
+	const auto endSample = startSample + numSamples;
+	auto position = startSample;
+	auto rendered = false;
+
+	for (const auto& metadata : events)
+	{
+		if (metadata.samplePosition < startSample)
+			continue;
+
+		if (metadata.samplePosition >= endSample)
+			break;
+
+		// Nothing the engine handles lives on channel 0, skip it before it gets copied into a MidiMessage
+		auto channel = SulfuricMidiRouter::getChannel(metadata);
+		if (channel == 0 || (midiChannel > 0 && channel != midiChannel))
+			continue;
+
+		auto timing = getEventTiming(metadata);
+		if (timing == EventTiming::ignored)
+			continue;
+
+		// Control-rate events move back to the grid line at or before them, so they never overtake a later note on
+		auto eventPosition = metadata.samplePosition;
+		if (timing == EventTiming::controlRate)
+			eventPosition = juce::jmax(position, eventPosition - (eventPosition - startSample) % controlInterval);
+
+		if (eventPosition > position)
+		{
+			rendered |= renderVoices(outputAudio, position, eventPosition - position);
+			position = eventPosition;
+		}
+
+		handleMidiEvent(metadata.getMessage());
+	}
+
+	if (position < endSample)
+		rendered |= renderVoices(outputAudio, position, endSample - position);
+
+	return rendered;
+}
+
+template <typename SampleType>
+bool SulfuricVoiceEngine::renderVoices(juce::AudioBuffer<SampleType>& outputAudio, int startSample, int numSamples)
+{
+	if (bank.getNumActiveVoices() == 0)
+		return false;
+
+	// A second channel is only worth rendering when there is one and the voices can sound different in it
+	const auto isStereo = outputAudio.getNumChannels() > 1 && bank.isStereo();
+
+	while (bank.getNumActiveVoices() > 0 && numSamples > 0)
+	{
+		const float* left;
+		const float* right = nullptr;
+		int chunkSize;
+
+		if (shouldRenderInParallel())
+		{
+			chunkSize = juce::jmin(numSamples, PARALLEL_CHUNK);
+			left = renderVoicesInParallel(chunkSize, isStereo);
+
+			if (isStereo)
+				right = left + PARALLEL_CHUNK;
+		}
+		else
+		{
+			chunkSize = juce::jmin(numSamples, SulfuricVoiceBank::RENDER_CHUNK);
+			juce::FloatVectorOperations::clear(leftBuffer.data(), chunkSize);
+
+			if (isStereo)
+				juce::FloatVectorOperations::clear(rightBuffer.data(), chunkSize);
+
+			bank.render(leftBuffer.data(), isStereo ? rightBuffer.data() : nullptr, chunkSize);
+			left = leftBuffer.data();
+
+			if (isStereo)
+				right = rightBuffer.data();
+		}
+
+		for (auto voice : bank.getFinishedVoices())
+			freeVoice(voice);
+
+		// In mono every channel gets the same signal
+		addToChannels(outputAudio, startSample, left, right, chunkSize);
+
+		startSample += chunkSize;
+		numSamples -= chunkSize;
+	}
+
+	return true;
+}
+
+bool SulfuricVoiceEngine::shouldRenderInParallel() const noexcept
+{
+	return workerPool != nullptr && parallelRendering && bank.getNumActiveVoices() >= parallelThreshold;
+}
+
+const float* SulfuricVoiceEngine::renderVoicesInParallel(int numSamples, bool isStereo) noexcept
+{
+	auto numGroups = bank.beginRender();
+	auto numJobs = (numGroups + GROUPS_PER_JOB - 1) / GROUPS_PER_JOB;
+
+	auto renderJob = [&](int job, int thread) noexcept
+	{
+		// Workers are audio threads too while they render
+		SULFURIC_REALTIME_SCOPE();
+
+		auto* left = jobOutput.data() + job * 2 * PARALLEL_CHUNK;
+		auto* right = isStereo ? left + PARALLEL_CHUNK : nullptr;
+		auto first = job * GROUPS_PER_JOB;
+
+		juce::FloatVectorOperations::clear(left, numSamples);
+		if (right != nullptr)
+			juce::FloatVectorOperations::clear(right, numSamples);
+
+		bank.renderGroups(left, right, numSamples, first, juce::jmin(first + GROUPS_PER_JOB, numGroups), threadScratch[(size_t)thread]);
+	};
+
+	workerPool->run(numJobs, renderJob);
+	bank.finishRender();
+
+	// Always in the same order, whichever thread rendered what
+	auto* total = jobOutput.data();
+
+	for (auto row = 0; row < (isStereo ? 2 : 1); ++row)
+	{
+		auto* channel = total + row * PARALLEL_CHUNK;
+
+		if (numJobs == 0)
+			juce::FloatVectorOperations::clear(channel, numSamples);
+
+		for (auto job = 1; job < numJobs; ++job)
+			juce::FloatVectorOperations::add(channel, channel + job * 2 * PARALLEL_CHUNK, numSamples);
+	}
+
+	return total;
+}
+
+// The processor renders in both precisions
+template bool SulfuricVoiceEngine::renderNextBlock(juce::AudioBuffer<float>&, const juce::MidiBuffer&, int, int, int);
+template bool SulfuricVoiceEngine::renderNextBlock(juce::AudioBuffer<double>&, const juce::MidiBuffer&, int, int, int);
+template bool SulfuricVoiceEngine::renderNextBlock(juce::AudioBuffer<float>&, const SulfuricMidiRouter::BusEvents&, int, int);
+template bool SulfuricVoiceEngine::renderNextBlock(juce::AudioBuffer<double>&, const SulfuricMidiRouter::BusEvents&, int, int);
+
+SulfuricVoiceEngine::EventTiming SulfuricVoiceEngine::getEventTiming(const juce::MidiMessageMetadata& metadata) noexcept
+{
+	// Only what handleMidiEvent acts on, read straight from the bytes
+	auto status = metadata.data[0] & 0xf0;
+
+	if (status == 0x90 && metadata.numBytes >= 3 && metadata.data[2] > 0)
+		return EventTiming::sampleAccurate;
+
+	if (status == 0x80 || status == 0x90)
+		return EventTiming::controlRate;
+
+	if (status == 0xb0 && metadata.numBytes >= 3)
+	{
+		switch (metadata.data[1])
+		{
+		case 0x40:	// Sustain pedal
+		case 0x78:	// All sound off
+		case 0x7b:	// All notes off
+			return EventTiming::controlRate;
+		default:
+			break;
+		}
+	}
+
+	return EventTiming::ignored;
+}
+
+void SulfuricVoiceEngine::handleMidiEvent(const juce::MidiMessage& message)
+{
+	const auto channel = message.getChannel();
+
+	if (message.isNoteOn())
+	{
+		noteOn(channel, message.getNoteNumber(), message.getFloatVelocity());
+	}
+	else if (message.isNoteOff())
+	{
+		noteOff(channel, message.getNoteNumber(), true);
+	}
+	else if (message.isAllNotesOff() || message.isAllSoundOff())
+	{
+		allNotesOff(channel, message.isAllNotesOff());
+	}
+	else if (message.isSustainPedalOn())
+	{
+		handleSustainPedal(channel, true);
+	}
+	else if (message.isSustainPedalOff())
+	{
+		handleSustainPedal(channel, false);
+	}
+}
+
+//==============================================================================
+void SulfuricVoiceEngine::noteOn(int midiChannel, int midiNoteNumber, float velocity)
+{
+	// If the same note is still ringing on this channel, let it tail off before starting again
+	if (auto previous = keyVoices[(size_t)getKey(midiChannel, midiNoteNumber)]; previous >= 0)
+		releaseVoice(previous, true);
+
+	startVoice(allocateVoice(), midiChannel, midiNoteNumber, velocity);
+}
+
+void SulfuricVoiceEngine::noteOff(int midiChannel, int midiNoteNumber, bool allowTailOff)
+{
+	auto voice = keyVoices[(size_t)getKey(midiChannel, midiNoteNumber)];
+	if (voice < 0)
+		return;
+
+	voiceKeyDown[(size_t)voice] = 0;
+
+	// A sustained voice stays in keyVoices, so playing the note again retriggers it
+	if (!sustainPedalsDown[(size_t)midiChannel])
+		releaseVoice(voice, allowTailOff);
+}
+
+void SulfuricVoiceEngine::allNotesOff(int midiChannel, bool allowTailOff)
+{
+	// Channel 0 means every channel
+	auto stopList = [&](VoiceList& list)
+	{
+		for (auto voice = list.first; voice >= 0;)
+		{
+			auto next = nextVoice[(size_t)voice];
+
+			if (midiChannel <= 0 || voiceKey[(size_t)voice] / 128 == midiChannel)
+				releaseVoice(voice, allowTailOff);
+
+			voice = next;
+		}
+	};
+
+	stopList(heldVoices);
+
+	// Released voices are tailing off already
+	if (!allowTailOff)
+		stopList(releasedVoices);
+
+	// Only the pedals of the channels it stopped, the others still hold their notes
+	if (midiChannel <= 0)
+		sustainPedalsDown.fill(false);
+	else
+		sustainPedalsDown[(size_t)midiChannel] = false;
+}
+
+void SulfuricVoiceEngine::handleSustainPedal(int midiChannel, bool isDown)
+{
+	jassert(midiChannel > 0 && midiChannel <= 16);
+	sustainPedalsDown[(size_t)midiChannel] = isDown;
+
+	if (isDown)
+		return;
+
+	for (auto voice = heldVoices.first; voice >= 0;)
+	{
+		auto next = nextVoice[(size_t)voice];
+
+		if (voiceKey[(size_t)voice] / 128 == midiChannel && !voiceKeyDown[(size_t)voice])
+			releaseVoice(voice, true);
+
+		voice = next;
+	}
+}
+
+//==============================================================================
+void SulfuricVoiceEngine::append(VoiceList& list, int voice) noexcept
+{
+	auto v = (size_t)voice;
+
+	previousVoice[v] = list.last;
+	nextVoice[v] = -1;
+
+	if (list.last >= 0)
+		nextVoice[(size_t)list.last] = voice;
+	else
+		list.first = voice;
+
+	list.last = voice;
+}
+
+void SulfuricVoiceEngine::remove(VoiceList& list, int voice) noexcept
+{
+	auto v = (size_t)voice;
+
+	if (previousVoice[v] >= 0)
+		nextVoice[(size_t)previousVoice[v]] = nextVoice[v];
+	else
+		list.first = nextVoice[v];
+
+	if (nextVoice[v] >= 0)
+		previousVoice[(size_t)nextVoice[v]] = previousVoice[v];
+	else
+		list.last = previousVoice[v];
+
+	previousVoice[v] = nextVoice[v] = -1;
+}
+
+SulfuricVoiceEngine::VoiceList& SulfuricVoiceEngine::getList(VoiceState state) noexcept
+{
+	jassert(state != VoiceState::free);
+	return state == VoiceState::held ? heldVoices : releasedVoices;
+}
+
+int SulfuricVoiceEngine::allocateVoice() noexcept
+{
+	if (bank.getNumActiveVoices() < polyphony && !freeVoices.empty())
+	{
+		auto voice = freeVoices.back();
+		freeVoices.pop_back();
+		return voice;
+	}
+
+	// Released longest ago is the quietest, and the oldest held note is the one least likely to be missed
+	auto voice = releasedVoices.first >= 0 ? releasedVoices.first : heldVoices.first;
+	jassert(voice >= 0);
+
+	// The bank restarts the voice in place
+	forgetVoice(voice);
+	return voice;
+}
+
+void SulfuricVoiceEngine::startVoice(int voice, int midiChannel, int midiNoteNumber, float velocity) noexcept
+{
+	auto v = (size_t)voice;
+	auto key = getKey(midiChannel, midiNoteNumber);
+
+	voiceKey[v] = key;
+	voiceKeyDown[v] = 1;
+	voiceState[v] = VoiceState::held;
+	append(heldVoices, voice);
+	keyVoices[(size_t)key] = voice;
+
+	auto frequency = notes->getFrequency(midiNoteNumber) * std::exp2(tuning / 12.0);
+	bank.startVoice(voice, frequency, 1.0f - velocitySensitivity + velocitySensitivity * velocity);
+}
+
+void SulfuricVoiceEngine::releaseVoice(int voice, bool allowTailOff) noexcept
+{
+	auto v = (size_t)voice;
+
+	if (!allowTailOff)
+	{
+		bank.stopVoice(voice, false);
+		freeVoice(voice);
+		return;
+	}
+
+	bank.stopVoice(voice, true);
+
+	if (keyVoices[(size_t)voiceKey[v]] == voice)
+		keyVoices[(size_t)voiceKey[v]] = -1;
+
+	if (voiceState[v] == VoiceState::held)
+	{
+		remove(heldVoices, voice);
+		voiceState[v] = VoiceState::released;
+		append(releasedVoices, voice);
+	}
+}
+
+int SulfuricVoiceEngine::releaseQuietestVoices(int maxHeld) noexcept
+{
+	// Within the capacity reserved up front, so this never allocates
+	heldScratch.clear();
+	for (auto voice = heldVoices.first; voice >= 0; voice = nextVoice[(size_t)voice])
+		heldScratch.push_back(voice);
+
+	auto numToRelease = (int)heldScratch.size() - juce::jmax(0, maxHeld);
+	if (numToRelease <= 0)
+		return 0;
+
+	// Only which voices are quietest matters, not their order
+	auto quietestEnd = heldScratch.begin() + numToRelease;
+	if (quietestEnd != heldScratch.end())
+		std::nth_element(heldScratch.begin(), quietestEnd - 1, heldScratch.end(),
+			[this](int a, int b) { return bank.getVoiceGain(a) < bank.getVoiceGain(b); });
+
+	for (auto voice = heldScratch.begin(); voice != quietestEnd; ++voice)
+		releaseVoice(*voice, true);
+
+	return numToRelease;
+}
+
+void SulfuricVoiceEngine::forgetVoice(int voice) noexcept
+{
+	auto v = (size_t)voice;
+
+	if (voiceState[v] == VoiceState::free)
+		return;
+
+	remove(getList(voiceState[v]), voice);
+	voiceState[v] = VoiceState::free;
+	voiceKeyDown[v] = 0;
+
+	if (keyVoices[(size_t)voiceKey[v]] == voice)
+		keyVoices[(size_t)voiceKey[v]] = -1;
+}
+
+void SulfuricVoiceEngine::freeVoice(int voice) noexcept
+{
+	if (voiceState[(size_t)voice] == VoiceState::free)
+		return;
+
+	forgetVoice(voice);
+	freeVoices.push_back(voice);
+}
\ No newline at end of file
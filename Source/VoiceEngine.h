@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+	Turns MIDI into voice starts and stops, and renders the voice bank.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "MidiRouter.h"
+#include "VoiceBank.h"
+#include "WorkerPool.h"
+
+//==============================================================================
+/**
+	Replaces juce::Synthesiser: no virtual voices, no lock, and every voice is
+	rendered in one pass over the SulfuricVoiceBank.
+
+	Rendering adds into the output buffer, and splits the block wherever an event
+	has to take effect. Note ons are sample-accurate. Note offs, the sustain pedal
+	and all notes off only take effect on a control-rate grid, and events the
+	engine doesn't act on don't split the block at all, so a dense stream of
+	controllers costs no more than an empty one.
+
+	Voices always render in float, and in mono unless a spread unison makes the
+	left and right channels differ. Each sample is then added to the channels by
+	a kernel specialised on the buffer's sample type and on mono or stereo, so a
+	double buffer costs one conversion per rendered sample, not per channel.
+*/
+class SulfuricVoiceEngine
+{
+public:
+	/** Allocates everything for maxVoices up front, setPolyphony() can then lower the limit at any time. */
+	explicit SulfuricVoiceEngine(int maxVoices);
+
+	void setCurrentPlaybackSampleRate(double);
+	void setQuality(OscillatorQuality);
+
+	/** Caps how many voices sound at once, any more steal. Voices already sounding above the cap are left to finish. */
+	void setPolyphony(int) noexcept;
+	int getPolyphony() const noexcept { return polyphony; }
+
+	/**
+		Events other than note ons take effect on the last multiple of this many samples from the start of
+		the render call at or before their own sample. 1 makes everything sample-accurate.
+	*/
+	void setControlInterval(int numSamples) noexcept;
+	int getControlInterval() const noexcept { return controlInterval; }
+
+	const static int DEFAULT_CONTROL_INTERVAL = 32;
+
+	int getNumVoices() const noexcept { return bank.getNumVoices(); }
+	int getNumActiveVoices() const noexcept { return bank.getNumActiveVoices(); }
+
+	/** The voice a note is held or sustained on, or -1. */
+	int getVoiceForNote(int midiChannel, int midiNoteNumber) const noexcept { return keyVoices[(size_t)getKey(midiChannel, midiNoteNumber)]; }
+
+	void setEnvelope(const SulfuricEnvelope::Parameters& parameters) noexcept { bank.setEnvelope(parameters); }
+	void setFilter(const SulfuricFilter::Parameters& parameters) noexcept { bank.setFilter(parameters); }
+	void setUnison(const SulfuricVoiceBank::Unison& parameters) noexcept { bank.setUnison(parameters); }
+
+	/** Transposes notes started from now on. */
+	void setTuning(float semitones) noexcept { tuning = semitones; }
+
+	/** 0 plays every note at full level, 1 follows the velocity all the way. */
+	void setVelocitySensitivity(float amount) noexcept { velocitySensitivity = amount; }
+
+	/**
+		Releases the quietest held voices, tails and all, until no more than maxHeld are held. Returns how many it
+		released. One selection pass over the held voices, still meant for shedding load rather than every block.
+	*/
+	int releaseQuietestVoices(int maxHeld) noexcept;
+
+	/** The tail a note leaves behind once it is released, in samples. */
+	int getTailLengthInSamples() const noexcept { return bank.getReleaseLengthInSamples(); }
+
+	/** Bytes this engine owns, its voice bank included, the tables it shares with other engines not. */
+	size_t getMemoryUsage() const noexcept;
+
+	//==============================================================================
+	/**
+		Lets rendering share the voices out over pool's threads, or stops it if pool is nullptr.
+		Allocates scratch space for every thread, so call it off the audio thread.
+
+		Voices are split into jobs of a few SIMD groups each, handed out as threads become free. Every job
+		renders into its own buffer and the buffers are summed in job order, so the output does not depend
+		on how many threads there are or which did what. It is not bit-identical to rendering on one thread.
+	*/
+	void setWorkerPool(SulfuricWorkerPool*);
+
+	/** Switches the worker pool on and off without reallocating, safe to call between blocks on the audio thread. */
+	void setParallelRendering(bool shouldRenderInParallel) noexcept { parallelRendering = shouldRenderInParallel; }
+
+	/** Below this many sounding voices waking the other threads costs more than it saves, so rendering stays on the caller. */
+	void setParallelThreshold(int minVoices) noexcept { parallelThreshold = minVoices; }
+
+	const static int DEFAULT_PARALLEL_THRESHOLD = 64;
+
+	/**
+		Plays every event in the buffer, or only those on midiChannel if it is 1 to 16.
+		Returns false if no voice was sounding at any point, leaving the buffer untouched.
+	*/
+	template <typename SampleType>
+	bool renderNextBlock(juce::AudioBuffer<SampleType>&, const juce::MidiBuffer&, int startSample, int numSamples, int midiChannel = 0);
+
+	/** Plays one bus worth of events from a SulfuricMidiRouter, returning false if nothing was rendered. */
+	template <typename SampleType>
+	bool renderNextBlock(juce::AudioBuffer<SampleType>&, const SulfuricMidiRouter::BusEvents&, int startSample, int numSamples);
+
+	//==============================================================================
+	// None of these scan the voices, except allNotesOff and releasing the sustain pedal
+	void noteOn(int midiChannel, int midiNoteNumber, float velocity);
+	void noteOff(int midiChannel, int midiNoteNumber, bool allowTailOff);
+	void allNotesOff(int midiChannel, bool allowTailOff);
+	void handleSustainPedal(int midiChannel, bool isDown);
+
+private:
+	template <typename SampleType, typename Events>
+	bool renderEvents(juce::AudioBuffer<SampleType>&, const Events&, int startSample, int numSamples, int midiChannel);
+
+	enum class EventTiming { ignored, controlRate, sampleAccurate };
+	static EventTiming getEventTiming(const juce::MidiMessageMetadata&) noexcept;
+
+	void handleMidiEvent(const juce::MidiMessage&);
+
+	template <typename SampleType>
+	bool renderVoices(juce::AudioBuffer<SampleType>&, int startSample, int numSamples);
+
+	bool shouldRenderInParallel() const noexcept;
+
+	/**
+		Renders numSamples, up to PARALLEL_CHUNK, over the worker pool into the first job's buffer and returns it.
+		In stereo the right channel follows PARALLEL_CHUNK samples after the left.
+	*/
+	const float* renderVoicesInParallel(int numSamples, bool isStereo) noexcept;
+
+	//==============================================================================
+	// Sounding voices sit in one of two lists, each ordered by when the voice joined it
+	enum class VoiceState : uint8_t { free, held, released };
+
+	struct VoiceList
+	{
+		int first = -1, last = -1;
+	};
+
+	void append(VoiceList&, int voice) noexcept;
+	void remove(VoiceList&, int voice) noexcept;
+	VoiceList& getList(VoiceState) noexcept;
+
+	/** A free voice if the polyphony allows, otherwise the voice released longest ago, otherwise the oldest held voice. */
+	int allocateVoice() noexcept;
+	void startVoice(int voice, int midiChannel, int midiNoteNumber, float velocity) noexcept;
+	void releaseVoice(int voice, bool allowTailOff) noexcept;
+	void forgetVoice(int voice) noexcept;
+	void freeVoice(int voice) noexcept;
+
+	static int getKey(int midiChannel, int midiNoteNumber) noexcept { return midiChannel * 128 + midiNoteNumber; }
+
+	SulfuricVoiceBank bank;
+	std::shared_ptr<const SulfuricNoteTable> notes;
+	int polyphony;
+	int controlInterval = DEFAULT_CONTROL_INTERVAL;
+	float tuning = 0.0f, velocitySensitivity = 1.0f;
+
+	// Per voice
+	std::vector<int> voiceKey, nextVoice, previousVoice;
+	std::vector<VoiceState> voiceState;
+	std::vector<uint8_t> voiceKeyDown;
+
+	// A stack, so the most recently freed voice is reused first
+	std::vector<int> freeVoices;
+
+	// Room for every voice, for releaseQuietestVoices to sort the held ones in
+	std::vector<int> heldScratch;
+	VoiceList heldVoices, releasedVoices;
+
+	// The voice each MIDI channel and note last started, while it is held or sustained, otherwise -1
+	std::array<int, 17 * 128> keyVoices;
+
+	// Indexed by MIDI channel, 1 to 16
+	std::array<bool, 17> sustainPedalsDown{};
+
+	// Only left is used in mono
+	std::array<float, SulfuricVoiceBank::RENDER_CHUNK> leftBuffer, rightBuffer;
+
+	//==============================================================================
+	// Fewer, longer runs of the pool, since each one has to wake the workers
+	const static int PARALLEL_CHUNK = 512;
+	const static int GROUPS_PER_JOB = 2;
+
+	SulfuricWorkerPool* workerPool = nullptr;
+	bool parallelRendering = true;
+	int parallelThreshold = DEFAULT_PARALLEL_THRESHOLD;
+
+	// One per pool thread
+	std::vector<SulfuricVoiceBank::Scratch> threadScratch;
+
+	// Two rows of PARALLEL_CHUNK samples per job, left then right
+	std::vector<float> jobOutput;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SulfuricVoiceEngine)
+};
@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+	Persistent threads the audio thread can hand one block's worth of
+	independent jobs to, without creating threads or taking locks.
+
+  ==============================================================================
+*/
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+	#include <emmintrin.h>
+	#define SULFURIC_PAUSE() _mm_pause()
+#else
+	#define SULFURIC_PAUSE() std::this_thread::yield()
+#endif
+
+//==============================================================================
+SulfuricWorkerPool::SulfuricWorkerPool(int numWorkers)
+{
+	workers.reserve((size_t)numWorkers);
+
+	for (auto thread = 1; thread <= numWorkers; ++thread)
+		workers.emplace_back([this, thread] { workerLoop(thread); });
+}
+
+SulfuricWorkerPool::~SulfuricWorkerPool()
+{
+	shouldExit = true;
+
+	// A new generation wakes everyone up to notice
+	state.fetch_add(uint64_t(1) << 32, std::memory_order_release);
+	state.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+}
+
+int SulfuricWorkerPool::getDefaultNumWorkers(int limit)
+{
+	auto cores = (int)std::thread::hardware_concurrency();
+	return std::clamp(cores - 1, 0, limit);
+}
+
+std::shared_ptr<SulfuricWorkerPool> SulfuricWorkerPool::getShared(int numWorkers)
+{
+	static std::mutex mutex;
+	static std::weak_ptr<SulfuricWorkerPool> shared;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (auto pool = shared.lock())
+		return pool;
+
+	auto pool = std::make_shared<SulfuricWorkerPool>(numWorkers);
+	shared = pool;
+	return pool;
+}
+
+//==============================================================================
+void SulfuricWorkerPool::run(int newNumJobs, JobFunction function, void* context) noexcept
+{
+	if (newNumJobs <= 0)
+		return;
+
+	// Someone else has the workers, most likely another instance, and waiting for them could take a whole block
+	if (workers.empty() || newNumJobs == 1 || isRunning.exchange(true, std::memory_order_acquire))
+	{
+		for (auto index = 0; index < newNumJobs; ++index)
+			function(context, index, 0);
+		return;
+	}
+
+	numJobs.store(newNumJobs, std::memory_order_relaxed);
+	jobFunction = function;
+	jobContext = context;
+	jobsRemaining.store(newNumJobs, std::memory_order_relaxed);
+
+	auto generation = (uint32_t)(state.load(std::memory_order_relaxed) >> 32) + 1;
+	state.store((uint64_t)generation << 32, std::memory_order_release);
+	state.notify_all();
+
+	runJobs(generation, 0);
+
+	// Whatever is left is already running on a worker
+	while (jobsRemaining.load(std::memory_order_acquire) > 0)
+		SULFURIC_PAUSE();
+
+	isRunning.store(false, std::memory_order_release);
+}
+
+int SulfuricWorkerPool::claimJob(uint32_t generation) noexcept
+{
+	auto current = state.load(std::memory_order_acquire);
+
+	for (;;)
+	{
+		auto index = (int)(uint32_t)current;
+
+		if ((uint32_t)(current >> 32) != generation || index >= numJobs.load(std::memory_order_relaxed))
+			return -1;
+
+		if (state.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+			return index;
+	}
+}
+
+void SulfuricWorkerPool::runJobs(uint32_t generation, int thread) noexcept
+{
+	for (auto index = claimJob(generation); index >= 0; index = claimJob(generation))
+	{
+		jobFunction(jobContext, index, thread);
+		jobsRemaining.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
+
+void SulfuricWorkerPool::workerLoop(int thread) noexcept
+{
+	uint32_t lastGeneration = 0;
+	auto spins = 0;
+
+	for (;;)
+	{
+		auto current = state.load(std::memory_order_acquire);
+		auto generation = (uint32_t)(current >> 32);
+
+		if (generation == lastGeneration)
+		{
+			// Runs tend to come in bursts within a block, so keep looking for a moment before paying for a wake-up
+			if (spins++ < SPINS_BEFORE_SLEEP)
+			{
+				SULFURIC_PAUSE();
+				continue;
+			}
+
+			// Sleeps until the audio thread publishes another run
+			state.wait(current, std::memory_order_acquire);
+			continue;
+		}
+
+		spins = 0;
+
+		if (shouldExit.load(std::memory_order_acquire))
+			return;
+
+		lastGeneration = generation;
+		runJobs(generation, thread);
+	}
+}
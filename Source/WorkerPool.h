@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+	Persistent threads the audio thread can hand one block's worth of
+	independent jobs to, without creating threads or taking locks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//==============================================================================
+/**
+	The calling thread takes jobs too, so a pool with no workers just runs
+	everything in place.
+
+	Waking the workers is an atomic notify (a futex wake on Linux), and waiting
+	for the last job is a spin, so neither blocks on a mutex the workers hold.
+
+	run() may be called from several threads at once, as it is when plugin
+	instances share the pool: one caller gets the workers and the others run
+	their jobs in place rather than wait for them.
+*/
+class SulfuricWorkerPool
+{
+public:
+	/** Starts numWorkers threads, so call it off the audio thread. */
+	explicit SulfuricWorkerPool(int numWorkers);
+	~SulfuricWorkerPool();
+
+	int getNumWorkers() const noexcept { return (int)workers.size(); }
+
+	/** The workers plus the caller of run(). */
+	int getNumThreads() const noexcept { return getNumWorkers() + 1; }
+
+	/**
+		Calls job(index, thread) for every index below numJobs, spread over the workers and the caller.
+		Returns once all of them have finished.
+
+		thread is 0 on the caller and 1 to getNumWorkers() on the workers, for indexing per-thread scratch space.
+		Jobs are handed out one at a time, so a thread that finishes early takes more of them.
+	*/
+	template <typename Job>
+	void run(int numJobs, Job& job) noexcept
+	{
+		run(numJobs, [](void* context, int index, int thread) noexcept { (*static_cast<Job*>(context))(index, thread); }, &job);
+	}
+
+	/** One worker per core besides the caller's, up to limit. */
+	static int getDefaultNumWorkers(int limit);
+
+	/**
+		The pool every plugin instance in the process shares, started with numWorkers threads if
+		nobody holds it yet, and stopped once the last holder lets go.
+
+		Takes a lock and may start threads, so call it off the audio thread.
+	*/
+	static std::shared_ptr<SulfuricWorkerPool> getShared(int numWorkers);
+
+private:
+	using JobFunction = void (*)(void* context, int index, int thread) noexcept;
+
+	void run(int numJobs, JobFunction, void* context) noexcept;
+	void workerLoop(int thread) noexcept;
+
+	/** Claims the next job of the given run, or returns -1 once that run has none left. */
+	int claimJob(uint32_t generation) noexcept;
+	void runJobs(uint32_t generation, int thread) noexcept;
+
+	const static int SPINS_BEFORE_SLEEP = 2000;
+
+	// The run's generation in the top 32 bits, the next unclaimed job below.
+	// Claiming by compare-and-swap means a worker still finishing one run can never take a job from the next.
+	std::atomic<uint64_t> state{ 0 };
+	std::atomic<int> jobsRemaining{ 0 };
+	std::atomic<bool> shouldExit{ false };
+
+	// Held by whichever run() has the workers
+	std::atomic<bool> isRunning{ false };
+
+	// A worker late out of one run may still read this while the next run sets it
+	std::atomic<int> numJobs{ 0 };
+
+	// Written before state is published for a run, read after a job of it has been claimed
+	JobFunction jobFunction = nullptr;
+	void* jobContext = nullptr;
+
+	std::vector<std::thread> workers;
+};
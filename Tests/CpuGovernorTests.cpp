@@ -0,0 +1,69 @@
+#include <CpuGovernor.h>
+#include <catch2/catch.hpp>
+
+namespace
+{
+  using Tier = SulfuricCpuGovernor::Tier;
+
+  // 480 samples at 48 kHz are due every 10 ms
+  Tier runBlocks(SulfuricCpuGovernor& governor, int numBlocks, double load)
+  {
+    auto tier = governor.getTier();
+    for (auto block = 0; block < numBlocks; ++block)
+      tier = governor.update(480, 0.01 * load);
+    return tier;
+  }
+}
+
+TEST_CASE("CPU governor steps down under sustained overload only", "[governor]")
+{
+  SulfuricCpuGovernor governor;
+  governor.prepare(48000.0);
+
+  // Spikes shorter than overloadBlocks are ignored
+  for (auto spike = 0; spike < 10; ++spike)
+  {
+    CHECK(runBlocks(governor, 3, 1.2) == Tier::full);
+    runBlocks(governor, 1, 0.5);
+  }
+
+  CHECK(runBlocks(governor, 4, 0.9) == Tier::cheapOscillators);
+  CHECK(runBlocks(governor, 4, 0.9) == Tier::coarseControl);
+  CHECK(runBlocks(governor, 4, 0.9) == Tier::shedVoices);
+
+  // Nothing below the last tier
+  CHECK(runBlocks(governor, 100, 2.0) == Tier::shedVoices);
+  CHECK(governor.getNumStepsDown() == 3);
+}
+
+TEST_CASE("CPU governor recovers with hysteresis", "[governor]")
+{
+  SulfuricCpuGovernor governor;
+  governor.prepare(48000.0);
+  runBlocks(governor, 8, 1.0);
+  REQUIRE(governor.getTier() == Tier::coarseControl);
+
+  // Between the thresholds it stays put either way
+  CHECK(runBlocks(governor, 1000, 0.6) == Tier::coarseControl);
+
+  // Recovering takes far longer than overloading did
+  CHECK(runBlocks(governor, 63, 0.2) == Tier::coarseControl);
+  CHECK(runBlocks(governor, 1, 0.2) == Tier::cheapOscillators);
+  CHECK(runBlocks(governor, 64, 0.2) == Tier::full);
+  CHECK(governor.getNumStepsUp() == 2);
+
+  // One heavy block resets the count
+  SulfuricCpuGovernor::Settings settings;
+  settings.recoveredBlocks = 4;
+  governor.setSettings(settings);
+  runBlocks(governor, 4, 1.0);
+  REQUIRE(governor.getTier() == Tier::cheapOscillators);
+  runBlocks(governor, 3, 0.1);
+  runBlocks(governor, 1, 0.6);
+  CHECK(runBlocks(governor, 3, 0.1) == Tier::cheapOscillators);
+  CHECK(runBlocks(governor, 1, 0.1) == Tier::full);
+
+  governor.prepare(48000.0);
+  CHECK(governor.getTier() == Tier::full);
+  CHECK(governor.getNumStepsDown() == 0);
+}
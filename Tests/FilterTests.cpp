@@ -0,0 +1,152 @@
+#include <VoiceBank.h>
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace
+{
+  constexpr double sampleRate = 48000.0;
+
+  // Runs a sine through every lane at once and returns each lane's peak once it has settled
+  std::vector<float> measureGains(const SulfuricFilter::Parameters& parameters, const std::vector<float>& cutoffs, double frequency)
+  {
+    std::vector<float> gains(SimdFloat::WIDTH);
+    for (auto lane = 0; lane < SimdFloat::WIDTH; ++lane)
+      gains[(size_t)lane] = SulfuricFilter::getGain(cutoffs[(size_t)lane % cutoffs.size()], sampleRate);
+
+    auto coefficients = SulfuricFilter::makeCoefficients(parameters, gains.data());
+    auto ic1 = SimdFloat::broadcast(0.0f), ic2 = SimdFloat::broadcast(0.0f);
+
+    std::vector<float> peaks(SimdFloat::WIDTH, 0.0f);
+    alignas(32) float lanes[SimdFloat::WIDTH];
+
+    for (auto i = 0; i < 48000; ++i)
+    {
+      auto input = (float)std::sin(2.0 * std::numbers::pi * frequency * i / sampleRate);
+      SulfuricFilter::process(SimdFloat::broadcast(input), coefficients, ic1, ic2).store(lanes);
+
+      if (i >= 24000)
+        for (auto lane = 0; lane < SimdFloat::WIDTH; ++lane)
+          peaks[(size_t)lane] = std::max(peaks[(size_t)lane], std::abs(lanes[lane]));
+    }
+
+    return peaks;
+  }
+
+  float render(SulfuricVoiceBank& bank, double frequency)
+  {
+    bank.setSampleRate(sampleRate);
+    bank.startVoice(0, frequency, 1.0f);
+
+    std::vector<float> output(4800, 0.0f);
+    bank.render(output.data(), (int)output.size());
+
+    auto sum = 0.0;
+    for (auto sample : output)
+      sum += sample * sample;
+    return (float)std::sqrt(sum / (double)output.size());
+  }
+}
+
+TEST_CASE("Filter modes have the textbook responses", "[filter]")
+{
+  SulfuricFilter::Parameters parameters;
+
+  // Without resonance Q is a half, so the cutoff itself is 6 dB down
+  parameters.mode = SulfuricFilter::Mode::lowPass;
+  CHECK(measureGains(parameters, { 1000.0f }, 1000.0)[0] == Approx(0.5f).margin(0.01f));
+  CHECK(measureGains(parameters, { 1000.0f }, 50.0)[0] == Approx(1.0f).margin(0.01f));
+
+  // 12 dB an octave, well above the cutoff
+  CHECK(measureGains(parameters, { 1000.0f }, 8000.0)[0] < 0.02f);
+
+  parameters.mode = SulfuricFilter::Mode::highPass;
+  CHECK(measureGains(parameters, { 1000.0f }, 50.0)[0] < 0.01f);
+  CHECK(measureGains(parameters, { 1000.0f }, 10000.0)[0] == Approx(1.0f).margin(0.02f));
+
+  parameters.mode = SulfuricFilter::Mode::bandPass;
+  CHECK(measureGains(parameters, { 1000.0f }, 1000.0)[0] == Approx(0.5f).margin(0.01f));
+
+  // Resonance lifts the band around the cutoff
+  parameters.mode = SulfuricFilter::Mode::lowPass;
+  parameters.resonance = 0.9f;
+  CHECK(measureGains(parameters, { 1000.0f }, 1000.0)[0] > 2.0f);
+}
+
+TEST_CASE("Filter lanes keep their own cutoffs", "[filter]")
+{
+  SulfuricFilter::Parameters parameters;
+  parameters.mode = SulfuricFilter::Mode::lowPass;
+
+  std::vector<float> cutoffs;
+  for (auto lane = 0; lane < SimdFloat::WIDTH; ++lane)
+    cutoffs.push_back(250.0f * (float)(1 << lane));
+
+  // Higher cutoffs let more of a 4 kHz tone through
+  auto gains = measureGains(parameters, cutoffs, 4000.0);
+  for (size_t lane = 1; lane < gains.size(); ++lane)
+    CHECK(gains[lane] > gains[lane - 1]);
+}
+
+TEST_CASE("Filter stays stable when its cutoff jumps every chunk", "[filter]")
+{
+  SulfuricFilter::Parameters parameters;
+  parameters.mode = SulfuricFilter::Mode::lowPass;
+  parameters.resonance = 1.0f;
+
+  auto ic1 = SimdFloat::broadcast(0.0f), ic2 = SimdFloat::broadcast(0.0f);
+  alignas(32) float gains[SimdFloat::WIDTH], lanes[SimdFloat::WIDTH];
+  auto peak = 0.0f;
+  uint32_t noise = 1;
+
+  for (auto chunk = 0; chunk < 2000; ++chunk)
+  {
+    // From the bottom of the range to the top and back, every 64 samples
+    for (auto lane = 0; lane < SimdFloat::WIDTH; ++lane)
+      gains[lane] = SulfuricFilter::getGain((chunk + lane) % 2 == 0 ? SulfuricFilter::MIN_HZ : 30000.0f, sampleRate);
+
+    auto coefficients = SulfuricFilter::makeCoefficients(parameters, gains);
+
+    for (auto i = 0; i < SulfuricVoiceBank::RENDER_CHUNK; ++i)
+    {
+      noise = noise * 1664525u + 1013904223u;
+      auto input = (float)(noise >> 8) / 8388608.0f - 1.0f;
+
+      SulfuricFilter::process(SimdFloat::broadcast(input), coefficients, ic1, ic2).store(lanes);
+      for (auto lane = 0; lane < SimdFloat::WIDTH; ++lane)
+        peak = std::max(peak, std::abs(lanes[lane]));
+    }
+  }
+
+  CHECK(std::isfinite(peak));
+  CHECK(peak < 100.0f);
+}
+
+TEST_CASE("Voice bank filters each voice, and the envelope moves the cutoff", "[filter][voicebank]")
+{
+  SulfuricVoiceBank unfiltered(8), filtered(8), opened(8);
+
+  SulfuricFilter::Parameters parameters;
+  parameters.mode = SulfuricFilter::Mode::lowPass;
+  parameters.cutoffHz = 200.0f;
+  filtered.setFilter(parameters);
+
+  parameters.envelopeOctaves = 5.0f;
+  opened.setFilter(parameters);
+
+  auto dry = render(unfiltered, 3200.0);
+  auto closed = render(filtered, 3200.0);
+  auto open = render(opened, 3200.0);
+
+  // Four octaves above the cutoff is about 48 dB down, the envelope opens it up to about an octave above
+  CHECK(closed < dry * 0.02f);
+  CHECK(open > dry * 0.2f);
+
+  // Off is the same as never having had a filter
+  parameters.mode = SulfuricFilter::Mode::off;
+  filtered.setFilter(parameters);
+  SulfuricVoiceBank fresh(8);
+  CHECK(render(filtered, 3200.0) == render(fresh, 3200.0));
+}
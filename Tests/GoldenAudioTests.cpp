@@ -0,0 +1,363 @@
+// Renders canned MIDI through the whole processor and compares it with Tests/Golden/references.json.
+// After a change that is meant to alter the sound, record new references with
+//   SULFURIC_RECORD_GOLDEN=1 ./Tests "[golden]"
+// and commit the file along with the change. A scenario without a reference fails.
+// Hidden from the default run, and so from ctest, until references.json holds references: run "[golden]" explicitly.
+
+#include <OfflineRenderer.h>
+#include <Simd.h>
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <complex>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+  constexpr int fftSize = 4096;
+  constexpr int numBands = 10;
+  constexpr double lowestBandHz = 20.0;
+
+  // Bands further than this below the loudest one are noise floor, and aren't compared
+  constexpr double dynamicRangeDb = 60.0;
+
+  // Differences in the last bits of a float, from another compiler or SIMD width, stay well inside these
+  constexpr double bandToleranceDb = 0.5;
+  constexpr double rmsToleranceDb = 0.1;
+
+  // Changing the block size moves where the control rate lands, which is allowed to move the spectrum a little
+  constexpr double blockSizeToleranceDb = 1.0;
+
+  struct Scenario
+  {
+    const char* name;
+    juce::MidiMessageSequence sequence;
+    std::vector<std::pair<const char*, float>> parameters;
+
+    // Longest the render may take, as a fraction of the audio's duration, in optimised builds
+    double budget;
+  };
+
+  struct Rendering
+  {
+    juce::String hash;
+    double rmsDb = 0.0;
+    std::vector<double> bandsDb;
+    double audioSeconds = 0.0, renderSeconds = 0.0;
+  };
+
+  juce::MidiMessageSequence makeArpeggio()
+  {
+    juce::MidiMessageSequence sequence;
+    const int pattern[] = { 0, 4, 7, 12, 16, 12, 7, 4 };
+
+    for (auto step = 0; step < 32; ++step)
+    {
+      auto note = 48 + (step / 8) * 5 + pattern[step % 8];
+      auto time = step * 0.125;
+      sequence.addEvent(juce::MidiMessage::noteOn(1, note, 0.4f + (float)(step % 5) * 0.15f), time);
+      sequence.addEvent(juce::MidiMessage::noteOff(1, note), time + 0.1);
+    }
+
+    sequence.updateMatchedPairs();
+    return sequence;
+  }
+
+  juce::MidiMessageSequence makePedalPassage()
+  {
+    juce::MidiMessageSequence sequence;
+    sequence.addEvent(juce::MidiMessage::controllerEvent(1, 64, 127), 0.0);
+
+    for (auto chord = 0; chord < 4; ++chord)
+      for (auto note : { 60, 64, 67 })
+      {
+        sequence.addEvent(juce::MidiMessage::noteOn(1, note + chord * 2, 0.7f), chord * 0.3);
+        sequence.addEvent(juce::MidiMessage::noteOff(1, note + chord * 2), chord * 0.3 + 0.1);
+      }
+
+    sequence.addEvent(juce::MidiMessage::controllerEvent(1, 64, 0), 1.5);
+    sequence.addEvent(juce::MidiMessage::noteOn(1, 72, 0.9f), 1.6);
+    sequence.addEvent(juce::MidiMessage::noteOff(1, 72), 2.0);
+
+    sequence.updateMatchedPairs();
+    return sequence;
+  }
+
+  // Enough voices at once to pass the engine's parallel threshold
+  juce::MidiMessageSequence makeCluster()
+  {
+    juce::MidiMessageSequence sequence;
+
+    for (auto note = 0; note < 96; ++note)
+    {
+      sequence.addEvent(juce::MidiMessage::noteOn(1, 16 + note, 0.3f + (float)(note % 7) * 0.1f), note * 0.005);
+      sequence.addEvent(juce::MidiMessage::noteOff(1, 16 + note), 1.0 + note * 0.005);
+    }
+
+    sequence.updateMatchedPairs();
+    return sequence;
+  }
+
+  std::vector<Scenario> getScenarios()
+  {
+    return {
+      { "chord", SulfuricOfflineRenderer::getPreviewSequence(), {}, 0.05 },
+      { "arpeggio", makeArpeggio(), { { "quality", 0.0f }, { "attack", 0.005f }, { "release", 0.1f } }, 0.05 },
+      { "pedal", makePedalPassage(), { { "quality", 3.0f }, { "release", 0.3f }, { "tune", 7.0f }, { "fine", 30.0f }, { "velocity", 0.5f } }, 0.05 },
+      { "cluster", makeCluster(), { { "polyphony", 128.0f }, { "master", 0.02f }, { "multicore", 1.0f } }, 0.5 },
+    };
+  }
+
+  void applyParameters(SulfuricAudioProcessor& processor, const Scenario& scenario)
+  {
+    for (auto& [id, value] : scenario.parameters)
+      for (auto* parameter : processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter); ranged != nullptr && ranged->paramID == id)
+          ranged->setValueNotifyingHost(ranged->convertTo0to1(value));
+  }
+
+  // FNV-1a over the raw bits of every sample
+  juce::String hashAudio(const juce::AudioBuffer<float>& audio)
+  {
+    juce::uint64 hash = 14695981039346656037ull;
+
+    for (auto channel = 0; channel < audio.getNumChannels(); ++channel)
+    {
+      auto bytes = reinterpret_cast<const juce::uint8*>(audio.getReadPointer(channel));
+      for (size_t byte = 0; byte < (size_t)audio.getNumSamples() * sizeof(float); ++byte)
+        hash = (hash ^ bytes[byte]) * 1099511628211ull;
+    }
+
+    return juce::String::toHexString((juce::int64)hash);
+  }
+
+  void fft(std::vector<std::complex<double>>& data)
+  {
+    const auto size = data.size();
+
+    for (size_t i = 1, j = 0; i < size; ++i)
+    {
+      auto bit = size >> 1;
+      for (; (j & bit) != 0; bit >>= 1)
+        j ^= bit;
+      j ^= bit;
+
+      if (i < j)
+        std::swap(data[i], data[j]);
+    }
+
+    for (size_t length = 2; length <= size; length <<= 1)
+    {
+      auto step = std::polar(1.0, -2.0 * juce::MathConstants<double>::pi / (double)length);
+
+      for (size_t start = 0; start < size; start += length)
+      {
+        std::complex<double> twiddle = 1.0;
+        for (size_t k = 0; k < length / 2; ++k)
+        {
+          auto even = data[start + k], odd = data[start + k + length / 2] * twiddle;
+          data[start + k] = even + odd;
+          data[start + k + length / 2] = even - odd;
+          twiddle *= step;
+        }
+      }
+    }
+  }
+
+  // Average energy per octave from lowestBandHz up, over half-overlapping Hann windows of the first channel
+  std::vector<double> getBandLevels(const juce::AudioBuffer<float>& audio, double sampleRate)
+  {
+    std::vector<double> energy(numBands, 0.0);
+    std::vector<std::complex<double>> frame(fftSize);
+    auto numFrames = 0;
+
+    for (auto start = 0; start + fftSize <= audio.getNumSamples(); start += fftSize / 2, ++numFrames)
+    {
+      for (auto i = 0; i < fftSize; ++i)
+      {
+        auto window = 0.5 - 0.5 * std::cos(2.0 * juce::MathConstants<double>::pi * i / fftSize);
+        frame[(size_t)i] = window * audio.getSample(0, start + i);
+      }
+
+      fft(frame);
+
+      for (auto bin = 1; bin < fftSize / 2; ++bin)
+      {
+        auto band = (int)std::floor(std::log2(bin * sampleRate / fftSize / lowestBandHz));
+        if (band >= 0 && band < numBands)
+          energy[(size_t)band] += std::norm(frame[(size_t)bin]);
+      }
+    }
+
+    for (auto& band : energy)
+      band = juce::Decibels::gainToDecibels(std::sqrt(band / juce::jmax(1, numFrames)), -200.0);
+
+    return energy;
+  }
+
+  Rendering render(const Scenario& scenario, double sampleRate, int blockSize)
+  {
+    SulfuricAudioProcessor processor;
+    applyParameters(processor, scenario);
+
+    SulfuricOfflineRenderer::Settings settings;
+    settings.sampleRate = sampleRate;
+    settings.blockSize = blockSize;
+    settings.tailSeconds = 0.5;
+
+    juce::AudioBuffer<float> audio;
+    auto result = SulfuricOfflineRenderer::render(processor, scenario.sequence, settings, audio);
+    REQUIRE(result.error.isEmpty());
+
+    Rendering rendering;
+    rendering.hash = hashAudio(audio);
+    rendering.rmsDb = juce::Decibels::gainToDecibels(audio.getRMSLevel(0, 0, audio.getNumSamples()), -200.0f);
+    rendering.bandsDb = getBandLevels(audio, sampleRate);
+    rendering.audioSeconds = result.audioSeconds;
+    rendering.renderSeconds = result.renderSeconds;
+    return rendering;
+  }
+
+  void checkBands(const std::vector<double>& actual, const std::vector<double>& expected, double toleranceDb)
+  {
+    REQUIRE(actual.size() == expected.size());
+    auto loudest = *std::max_element(expected.begin(), expected.end());
+
+    for (size_t band = 0; band < expected.size(); ++band)
+    {
+      INFO("band " << band << " from " << lowestBandHz * std::pow(2.0, (double)band) << " Hz");
+      if (juce::jmax(actual[band], expected[band]) > loudest - dynamicRangeDb)
+        CHECK(actual[band] == Approx(expected[band]).margin(toleranceDb));
+    }
+  }
+
+  // Exact output depends on the compiler, the SIMD width and the architecture, so hashes are only compared within one of these
+  juce::String getBuildTag()
+  {
+   #if JUCE_CLANG
+    juce::String compiler = "clang";
+   #elif JUCE_GCC
+    juce::String compiler = "gcc";
+   #elif JUCE_MSVC
+    juce::String compiler = "msvc";
+   #else
+    juce::String compiler = "other";
+   #endif
+
+   #if JUCE_INTEL
+    juce::String architecture = "x86";
+   #elif JUCE_ARM
+    juce::String architecture = "arm";
+   #else
+    juce::String architecture = "other";
+   #endif
+
+    return architecture + "-simd" + juce::String(SimdFloat::WIDTH) + "-" + compiler;
+  }
+
+  juce::File getReferenceFile()
+  {
+    return juce::File(SULFURIC_GOLDEN_DIR).getChildFile("references.json");
+  }
+
+  bool isRecording()
+  {
+    auto* record = std::getenv("SULFURIC_RECORD_GOLDEN");
+    return record != nullptr && juce::String(record) != "0";
+  }
+
+  juce::var toVar(const std::vector<double>& values)
+  {
+    juce::Array<juce::var> array;
+    for (auto value : values)
+      array.add(std::round(value * 1000.0) / 1000.0);
+    return array;
+  }
+
+  std::vector<double> fromVar(const juce::var& array)
+  {
+    std::vector<double> values;
+    if (auto* elements = array.getArray())
+      for (auto& element : *elements)
+        values.push_back((double)element);
+    return values;
+  }
+}
+
+TEST_CASE("Scenarios sound the same as their references", "[.golden]")
+{
+  auto referenceFile = getReferenceFile();
+  auto references = juce::JSON::parse(referenceFile);
+  if (!references.isObject())
+    references = new juce::DynamicObject();
+
+  auto buildTag = getBuildTag();
+  auto recording = isRecording();
+
+  for (auto& scenario : getScenarios())
+  {
+    for (auto sampleRate : { 44100.0, 48000.0, 96000.0 })
+    {
+      std::vector<double> firstBlockSizeBands;
+
+      for (auto blockSize : { 64, 512 })
+      {
+        auto key = juce::String(scenario.name) + "@" + juce::String((int)sampleRate) + "/" + juce::String(blockSize);
+        INFO(key << " on " << buildTag);
+
+        auto rendering = render(scenario, sampleRate, blockSize);
+
+        // Nothing here should depend on what ran before, threads included
+        CHECK(render(scenario, sampleRate, blockSize).hash == rendering.hash);
+
+        if (firstBlockSizeBands.empty())
+          firstBlockSizeBands = rendering.bandsDb;
+        else
+          checkBands(rendering.bandsDb, firstBlockSizeBands, blockSizeToleranceDb);
+
+       #if !JUCE_DEBUG
+        CHECK(rendering.renderSeconds <= rendering.audioSeconds * scenario.budget);
+       #endif
+
+        auto reference = references[juce::Identifier(key)];
+
+        if (recording)
+        {
+          auto* hashes = reference["hashes"].getDynamicObject();
+          juce::var newHashes(hashes != nullptr ? hashes->clone().get() : new juce::DynamicObject());
+          newHashes.getDynamicObject()->setProperty(buildTag, rendering.hash);
+
+          auto* entry = new juce::DynamicObject();
+          entry->setProperty("rmsDb", std::round(rendering.rmsDb * 1000.0) / 1000.0);
+          entry->setProperty("bandsDb", toVar(rendering.bandsDb));
+          entry->setProperty("hashes", newHashes);
+          references.getDynamicObject()->setProperty(key, entry);
+          continue;
+        }
+
+        if (!reference.isObject())
+        {
+          // A scenario nobody recorded would otherwise pass without ever being compared
+          FAIL_CHECK("No reference for " << key << ", record one with SULFURIC_RECORD_GOLDEN=1");
+          continue;
+        }
+
+        CHECK(rendering.rmsDb == Approx((double)reference["rmsDb"]).margin(rmsToleranceDb));
+        checkBands(rendering.bandsDb, fromVar(reference["bandsDb"]), bandToleranceDb);
+
+        // Bit-exact, but only against a reference made by the same kind of build
+        auto hash = reference["hashes"][juce::Identifier(buildTag)];
+        if (!hash.isVoid())
+          CHECK(rendering.hash == hash.toString());
+      }
+    }
+  }
+
+  if (recording)
+  {
+    referenceFile.getParentDirectory().createDirectory();
+    REQUIRE(referenceFile.replaceWithText(juce::JSON::toString(references) + "\n"));
+    WARN("Recorded " << referenceFile.getFullPathName());
+  }
+}
@@ -0,0 +1,188 @@
+#include <LoadMeter.h>
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Load meter summarises blocks against their real-time budget", "[load]")
+{
+  SulfuricLoadMeter meter;
+  meter.prepare(48000.0);
+
+  // 480 samples last 10 ms
+  SulfuricLoadMeter::BlockTiming timing;
+  timing.numSamples = 480;
+  timing.activeVoices = 3;
+  timing.renderSeconds = 0.0009;
+  timing.gainSeconds = 0.0001;
+  timing.blockSeconds = 0.001;
+  meter.push(timing);
+
+  timing.activeVoices = 2;
+  timing.blockSeconds = 0.003;
+  meter.push(timing);
+
+  auto snapshot = meter.getSnapshot();
+  CHECK(snapshot.lastLoad == Approx(0.3));
+  CHECK(snapshot.averageLoad > 0.1);
+  CHECK(snapshot.averageLoad < 0.3);
+  CHECK(snapshot.recentPeakLoad == Approx(0.3));
+  CHECK(snapshot.worstLoad == Approx(0.3));
+  CHECK(snapshot.lastBlockSeconds == Approx(0.003));
+  CHECK(snapshot.worstBlockSeconds == Approx(0.003));
+  CHECK(snapshot.averageRenderSeconds == Approx(0.0009));
+  CHECK(snapshot.activeVoices == 2);
+  CHECK(snapshot.maxActiveVoices == 3);
+  CHECK(snapshot.totalBlocks == 2);
+
+  // Nothing was taken away, asking again gives the same figures
+  auto again = meter.getSnapshot();
+  CHECK(again.averageLoad == snapshot.averageLoad);
+  CHECK(again.totalBlocks == 2);
+
+  // A second of quieter blocks pulls the average and the recent peak down, the worst block stays
+  timing.blockSeconds = 0.001;
+  for (auto i = 0; i < 100; ++i)
+    meter.push(timing);
+
+  snapshot = meter.getSnapshot();
+  CHECK(snapshot.averageLoad < 0.13);
+  CHECK(snapshot.recentPeakLoad < 0.13);
+  CHECK(snapshot.worstLoad == Approx(0.3));
+  CHECK(snapshot.totalBlocks == 102);
+}
+
+TEST_CASE("Load meter reports the CPU governor's tier changes", "[load][governor]")
+{
+  SulfuricLoadMeter meter;
+  meter.prepare(48000.0);
+
+  SulfuricLoadMeter::BlockTiming timing;
+  timing.numSamples = 480;
+
+  for (auto tier : { 0, 1, 2, 2, 1 })
+  {
+    timing.governorTier = tier;
+    meter.push(timing);
+  }
+
+  auto snapshot = meter.getSnapshot();
+  CHECK(snapshot.governorTier == 1);
+  CHECK(snapshot.worstGovernorTier == 2);
+  CHECK(snapshot.governorChanges == 3);
+
+  timing.governorTier = 0;
+  meter.push(timing);
+  snapshot = meter.getSnapshot();
+  CHECK(snapshot.governorTier == 0);
+  CHECK(snapshot.worstGovernorTier == 2);
+  CHECK(snapshot.governorChanges == 4);
+}
+
+TEST_CASE("Load meter drops blocks instead of blocking when nobody reads", "[load]")
+{
+  SulfuricLoadMeter meter;
+  meter.prepare(48000.0);
+
+  SulfuricLoadMeter::BlockTiming timing;
+  timing.numSamples = 64;
+
+  // Tier changes in the dropped blocks still count
+  for (auto i = 0; i < 10000; ++i)
+  {
+    timing.governorTier = i == 9000 ? 1 : 0;
+    meter.push(timing);
+  }
+
+  auto snapshot = meter.getSnapshot();
+  CHECK(snapshot.totalBlocks + snapshot.droppedBlocks == 10000);
+  CHECK(snapshot.droppedBlocks > 0);
+  CHECK(snapshot.governorChanges == 2);
+  CHECK(snapshot.worstGovernorTier == 1);
+}
+
+TEST_CASE("Load meter starts over when prepared again, without the readers' help", "[load]")
+{
+  SulfuricLoadMeter meter;
+  meter.prepare(48000.0);
+
+  SulfuricLoadMeter::BlockTiming timing;
+  timing.numSamples = 480;
+  timing.blockSeconds = 0.008;
+  timing.governorTier = 2;
+
+  meter.push(timing);
+  meter.push(timing);
+  CHECK(meter.getSnapshot().totalBlocks == 2);
+
+  // Left in the FIFO when the host prepares again
+  meter.push(timing);
+
+  meter.prepare(96000.0);
+  timing.numSamples = 960;
+  timing.blockSeconds = 0.001;
+  timing.governorTier = 0;
+  meter.push(timing);
+
+  auto snapshot = meter.getSnapshot();
+  CHECK(snapshot.totalBlocks == 1);
+  CHECK(snapshot.worstLoad == Approx(0.1));
+  CHECK(snapshot.worstGovernorTier == 0);
+  CHECK(snapshot.governorChanges == 0);
+}
+
+TEST_CASE("Load meter gives every reader the whole picture", "[load]")
+{
+  SulfuricLoadMeter meter;
+  meter.prepare(48000.0);
+
+  constexpr auto numBlocks = 20000;
+  std::atomic<bool> done{ false };
+  std::atomic<int> torn{ 0 }, backwards{ 0 };
+
+  // An editor and a host-side monitor, say, both watching while the audio thread pushes
+  auto watch = [&]
+  {
+    juce::uint64 lastTotal = 0;
+    while (!done.load())
+    {
+      auto snapshot = meter.getSnapshot();
+
+      // Every block pushed has 8 voices, a half-written snapshot would show something else
+      if (snapshot.totalBlocks > 0 && (snapshot.activeVoices != 8 || snapshot.maxActiveVoices != 8))
+        ++torn;
+      if (snapshot.totalBlocks < lastTotal)
+        ++backwards;
+      lastTotal = snapshot.totalBlocks;
+    }
+  };
+
+  std::vector<std::thread> readers;
+  for (auto i = 0; i < 3; ++i)
+    readers.emplace_back(watch);
+
+  SulfuricLoadMeter::BlockTiming timing;
+  timing.numSamples = 64;
+  timing.activeVoices = 8;
+  timing.blockSeconds = 0.0005;
+  for (auto i = 0; i < numBlocks; ++i)
+  {
+    meter.push(timing);
+    if (i % 256 == 0)
+      std::this_thread::yield();
+  }
+
+  done = true;
+  for (auto& reader : readers)
+    reader.join();
+
+  CHECK(torn == 0);
+  CHECK(backwards == 0);
+
+  // Whoever asks last sees every block, none of them lost to the other readers
+  auto first = meter.getSnapshot();
+  auto second = meter.getSnapshot();
+  CHECK(first.totalBlocks + first.droppedBlocks == (juce::uint64)numBlocks);
+  CHECK(second.totalBlocks == first.totalBlocks);
+}
@@ -0,0 +1,53 @@
+#include <MidiRouter.h>
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+TEST_CASE("MIDI router sends channel n + 1 to bus n in time order", "[midi]")
+{
+  SulfuricMidiRouter router;
+  router.prepare(2, 16);
+
+  juce::MidiBuffer midi;
+  midi.addEvent(juce::MidiMessage::noteOn(1, 60, 1.0f), 0);
+  midi.addEvent(juce::MidiMessage::noteOn(2, 62, 1.0f), 10);
+  midi.addEvent(juce::MidiMessage::noteOff(1, 60), 20);
+  midi.addEvent(juce::MidiMessage::noteOn(3, 64, 1.0f), 30); // No bus 2
+  midi.addEvent(juce::MidiMessage::noteOff(2, 62), 40);
+
+  REQUIRE(router.route(midi));
+
+  std::vector<int> positions;
+  for (const auto& metadata : router.getEventsForBus(0))
+  {
+    CHECK(metadata.getMessage().getChannel() == 1);
+    positions.push_back(metadata.samplePosition);
+  }
+  CHECK(positions == std::vector<int>{ 0, 20 });
+
+  positions.clear();
+  for (const auto& metadata : router.getEventsForBus(1))
+  {
+    CHECK(metadata.getMessage().getChannel() == 2);
+    positions.push_back(metadata.samplePosition);
+  }
+  CHECK(positions == std::vector<int>{ 10, 40 });
+
+  // Routing again replaces the previous block
+  midi.clear();
+  REQUIRE(router.route(midi));
+  CHECK(router.getEventsForBus(0).isEmpty());
+  CHECK(router.getEventsForBus(1).isEmpty());
+}
+
+TEST_CASE("MIDI router reports overflow", "[midi]")
+{
+  SulfuricMidiRouter router;
+  router.prepare(1, 2);
+
+  juce::MidiBuffer midi;
+  for (auto i = 0; i < 3; ++i)
+    midi.addEvent(juce::MidiMessage::noteOn(1, 60 + i, 1.0f), i);
+
+  CHECK_FALSE(router.route(midi));
+}
@@ -0,0 +1,128 @@
+#include <ParameterEngine.h>
+#include <catch2/catch.hpp>
+
+TEST_CASE("Parameter engine ramps linearly over the smoothing time", "[parameters]")
+{
+  std::atomic<float> gain { 0.0f }, other { 3.0f };
+
+  SulfuricParameterEngine engine;
+  auto gainIndex = engine.add(&gain, SulfuricParameterEngine::Smoothing::linear, 0.01);
+  auto otherIndex = engine.add(&other);
+  engine.prepare(1000.0, 8);
+
+  gain = 1.0f;
+  engine.process(8);
+
+  // 10 ms at 1 kHz is ten samples
+  REQUIRE(engine.isSmoothing(gainIndex));
+  CHECK(engine.getRamp(gainIndex)[0] == Approx(0.1f));
+  CHECK(engine.getRamp(gainIndex)[7] == Approx(0.8f));
+  CHECK(engine.getValue(gainIndex) == Approx(0.8f));
+  CHECK_FALSE(engine.isSmoothing(otherIndex));
+  CHECK(engine.getValue(otherIndex) == 3.0f);
+
+  engine.process(8);
+  CHECK(engine.getRamp(gainIndex)[1] == 1.0f);
+  CHECK(engine.getRamp(gainIndex)[7] == 1.0f);
+  CHECK(engine.getValue(gainIndex) == 1.0f);
+
+  // Settled, so the next block skips it
+  engine.process(8);
+  CHECK_FALSE(engine.isSmoothing(gainIndex));
+}
+
+TEST_CASE("Parameter engine follows a target that moves mid-ramp", "[parameters]")
+{
+  std::atomic<float> gain { 0.0f };
+
+  SulfuricParameterEngine engine;
+  engine.add(&gain, SulfuricParameterEngine::Smoothing::linear, 0.004);
+  engine.prepare(1000.0, 2);
+
+  gain = 1.0f;
+  engine.process(2);
+  CHECK(engine.getValue(0) == Approx(0.5f));
+
+  // Heads back down from 0.5, no jump
+  gain = 0.0f;
+  engine.process(2);
+  CHECK(engine.getRamp(0)[0] == Approx(0.375f));
+  CHECK(engine.getValue(0) == Approx(0.25f));
+}
+
+TEST_CASE("Parameter engine settles exponential smoothing", "[parameters]")
+{
+  std::atomic<float> value { 0.0f };
+
+  SulfuricParameterEngine engine;
+  engine.add(&value, SulfuricParameterEngine::Smoothing::exponential, 0.001);
+  engine.prepare(48000.0, 64);
+
+  value = 2.0f;
+  engine.process(48);
+
+  // One time constant in
+  CHECK(engine.getValue(0) == Approx(2.0f * (1.0f - std::exp(-1.0f))).margin(1e-3));
+
+  for (auto block = 0; block < 20; ++block)
+    engine.process(64);
+
+  CHECK(engine.getValue(0) == 2.0f);
+  CHECK_FALSE(engine.isSmoothing(0));
+}
+
+TEST_CASE("Parameter engine keeps time across blocks bigger than it was prepared for", "[parameters]")
+{
+  std::atomic<float> gain { 0.0f };
+
+  SulfuricParameterEngine engine;
+  engine.add(&gain, SulfuricParameterEngine::Smoothing::linear, 0.01);
+  engine.prepare(1000.0, 4);
+
+  gain = 1.0f;
+  engine.process(6);
+  CHECK(engine.getRamp(0)[3] == Approx(0.4f));
+  CHECK(engine.getValue(0) == Approx(0.6f));
+}
+
+TEST_CASE("Parameter engine jumps parameters without smoothing", "[parameters]")
+{
+  std::vector<std::atomic<float>> values(11);
+
+  SulfuricParameterEngine engine;
+  for (auto& value : values)
+    engine.add(&value);
+  engine.prepare(44100.0, 16);
+
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = (float)i;
+  engine.process(16);
+
+  for (auto i = 0; i < engine.getNumParameters(); ++i)
+  {
+    CHECK(engine.getValue(i) == (float)i);
+    CHECK_FALSE(engine.isSmoothing(i));
+  }
+}
+
+TEST_CASE("Parameter engine keeps each ramp apart from the rest of its group", "[parameters]")
+{
+  std::vector<std::atomic<float>> values(11);
+
+  SulfuricParameterEngine engine;
+  for (auto& value : values)
+    engine.add(&value, SulfuricParameterEngine::Smoothing::linear, 0.004);
+  engine.prepare(1000.0, 4);
+
+  // Every parameter heads somewhere different, in both the first group and the last
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = (float)(i + 1);
+  engine.process(4);
+
+  for (auto i = 0; i < engine.getNumParameters(); ++i)
+  {
+    REQUIRE(engine.isSmoothing(i));
+    for (auto sample = 0; sample < 4; ++sample)
+      CHECK(engine.getRamp(i)[sample] == Approx((float)(i + 1) * (float)(sample + 1) / 4.0f));
+  }
+}
@@ -0,0 +1,58 @@
+#include <OfflineRenderer.h>
+#include <PatchGenerator.h>
+#include <catch2/catch.hpp>
+
+TEST_CASE("A seed always generates the same patch", "[patches]")
+{
+  SulfuricAudioProcessor first, second;
+  auto& parameters = first.getPatchParameters();
+  REQUIRE(parameters.size() > 0);
+  REQUIRE(parameters.size() <= 18);
+
+  SulfuricPatchGenerator::apply(0x5eed, first);
+  SulfuricPatchGenerator::apply(0x5eed, second);
+
+  auto numDifferent = 0;
+  for (auto index = 0; index < parameters.size(); ++index)
+  {
+    auto value = parameters[index]->getValue();
+    CHECK(value >= 0.0f);
+    CHECK(value <= 1.0f);
+    CHECK(value == second.getPatchParameters()[index]->getValue());
+
+    numDifferent += SulfuricPatchGenerator::getValue(0x5eed, *parameters[index]) != SulfuricPatchGenerator::getValue(0x5eee, *parameters[index]) ? 1 : 0;
+  }
+
+  // Neighbouring seeds give unrelated patches
+  CHECK(numDifferent > parameters.size() / 2);
+}
+
+TEST_CASE("Auditions measure the preview", "[patches]")
+{
+  constexpr double sampleRate = 48000.0;
+  constexpr double frequency = 1000.0;
+
+  juce::AudioBuffer<float> sine(1, 4800);
+  for (auto i = 0; i < sine.getNumSamples(); ++i)
+    sine.setSample(0, i, 0.5f * (float)std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate));
+
+  auto audition = SulfuricOfflineRenderer::analyse(sine, sampleRate);
+  CHECK(audition.peak == Approx(0.5f).margin(1e-3));
+  CHECK(audition.rms == Approx(0.5f / std::sqrt(2.0f)).margin(1e-3));
+  CHECK(audition.brightness == Approx(2.0 * std::sin(juce::MathConstants<double>::pi * frequency / sampleRate)).margin(1e-2));
+  CHECK(audition.attackSeconds < 0.001f);
+
+  // Batches come back in seed order, and match auditioning one seed at a time
+  SulfuricOfflineRenderer::Settings settings;
+  settings.tailSeconds = 0.25;
+
+  auto batch = SulfuricOfflineRenderer::auditionSeeds(100, 8, settings, 4);
+  REQUIRE(batch.size() == 8);
+
+  SulfuricAudioProcessor processor;
+  for (auto index = 0; index < 8; ++index)
+  {
+    CHECK(batch[(size_t)index].seed == 100 + (juce::uint64)index);
+    CHECK(batch[(size_t)index].rms == SulfuricOfflineRenderer::audition(processor, 100 + (juce::uint64)index, settings).rms);
+  }
+}
@@ -0,0 +1,120 @@
+#include <PresetBank.h>
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <thread>
+
+TEST_CASE("Preset banks round trip through one file", "[presets]")
+{
+  juce::TemporaryFile temporary(".sulfuricbank");
+  auto file = temporary.getFile();
+
+  std::vector<SulfuricPresetBank::Preset> presets(3);
+  for (auto index = 0; index < 3; ++index)
+  {
+    presets[(size_t)index].name = "Preset " + juce::String(index) + juce::String::fromUTF8(" \xc3\xa9");
+    for (auto byte = 0; byte <= index * 10; ++byte)
+      presets[(size_t)index].state.append(&byte, 1);
+  }
+
+  REQUIRE(SulfuricPresetBank::write(file, presets));
+
+  auto bank = SulfuricPresetBank::open(file);
+  REQUIRE(bank != nullptr);
+  REQUIRE(bank->getNumPresets() == 3);
+
+  for (auto index = 0; index < 3; ++index)
+  {
+    CHECK(bank->getName(index) == presets[(size_t)index].name);
+
+    auto state = bank->getState(index);
+    CHECK(juce::MemoryBlock(state.data, (size_t)state.size) == presets[(size_t)index].state);
+  }
+
+  auto copied = bank->getPresets();
+  REQUIRE(copied.size() == presets.size());
+  CHECK(copied[2].state == presets[2].state);
+}
+
+TEST_CASE("Preset banks that aren't one don't open", "[presets]")
+{
+  juce::TemporaryFile temporary(".sulfuricbank");
+  auto file = temporary.getFile();
+
+  CHECK(SulfuricPresetBank::open(file) == nullptr);
+
+  file.replaceWithText("definitely not a preset bank");
+  CHECK(SulfuricPresetBank::open(file) == nullptr);
+
+  // An index pointing past the end of the file
+  std::vector<SulfuricPresetBank::Preset> presets(1);
+  presets[0].name = "Truncated";
+  presets[0].state.setSize(100, true);
+  REQUIRE(SulfuricPresetBank::write(file, presets));
+
+  juce::MemoryBlock data;
+  file.loadFileAsData(data);
+  data.setSize(data.getSize() - 50);
+  file.replaceWithData(data.getData(), data.getSize());
+
+  CHECK(SulfuricPresetBank::open(file) == nullptr);
+}
+
+TEST_CASE("Saving adds to the bank on disk, whatever anyone has open", "[presets]")
+{
+  juce::TemporaryFile temporary(".sulfuricbank");
+  auto file = temporary.getFile();
+
+  auto makePreset = [](const juce::String& name)
+  {
+    SulfuricPresetBank::Preset preset;
+    preset.name = name;
+    preset.state.append(name.toRawUTF8(), name.getNumBytesAsUTF8());
+    return preset;
+  };
+
+  // No bank yet, like an editor whose bank is still loading
+  auto nothing = SulfuricPresetBank::open(file);
+  CHECK(nothing == nullptr);
+  CHECK(SulfuricPresetBank::append(file, makePreset("First")) == 0);
+
+  // An editor that opened the bank before another instance saved
+  auto stale = SulfuricPresetBank::open(file);
+  REQUIRE(stale != nullptr);
+
+  auto other = SulfuricPresetBank::open(file);
+  CHECK(SulfuricPresetBank::append(file, makePreset("Second")) == 1);
+  CHECK(SulfuricPresetBank::append(file, makePreset("Third")) == 2);
+  stale.reset();
+  other.reset();
+
+  auto bank = SulfuricPresetBank::open(file);
+  REQUIRE(bank != nullptr);
+  REQUIRE(bank->getNumPresets() == 3);
+  CHECK(bank->getName(0) == "First");
+  CHECK(bank->getName(1) == "Second");
+  CHECK(bank->getName(2) == "Third");
+
+  auto state = bank->getState(1);
+  CHECK(juce::MemoryBlock(state.data, (size_t)state.size) == makePreset("Second").state);
+  bank.reset();
+
+  // Instances saving at the same moment take turns, Catch can't check from other threads
+  std::atomic<int> failedSaves{ 0 };
+  std::vector<std::thread> savers;
+  for (auto saver = 0; saver < 4; ++saver)
+    savers.emplace_back([&, saver]
+    {
+      for (auto index = 0; index < 5; ++index)
+        if (SulfuricPresetBank::append(file, makePreset("Saver " + juce::String(saver) + " " + juce::String(index))) < 0)
+          ++failedSaves;
+    });
+
+  for (auto& saver : savers)
+    saver.join();
+
+  CHECK(failedSaves == 0);
+  bank = SulfuricPresetBank::open(file);
+  REQUIRE(bank != nullptr);
+  CHECK(bank->getNumPresets() == 23);
+}
@@ -0,0 +1,235 @@
+#include <OfflineRenderer.h>
+#include <PluginSynthesiser.h>
+#include <StateFormat.h>
+#include <catch2/catch.hpp>
+
+#include <set>
+
+namespace
+{
+  constexpr double sampleRate = 48000.0;
+  constexpr int blockSize = 256;
+
+  bool isSilent(const juce::AudioBuffer<float>& buffer)
+  {
+    for (auto channel = 0; channel < buffer.getNumChannels(); ++channel)
+      if (buffer.getMagnitude(channel, 0, buffer.getNumSamples()) != 0.0f)
+        return false;
+    return true;
+  }
+}
+
+TEST_CASE("Idle blocks come back cleared, and the tail covers the release", "[processor]")
+{
+  SulfuricAudioProcessor processor;
+  processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+  processor.prepareToPlay(sampleRate, blockSize);
+
+  juce::AudioBuffer<float> buffer(2, blockSize);
+  juce::MidiBuffer midi;
+
+  // Whatever the host left in the buffer, an idle block is silent
+  buffer.applyGain(0.0f);
+  buffer.setSample(0, 0, 1.0f);
+  processor.processBlock(buffer, midi);
+  CHECK(buffer.hasBeenCleared());
+
+  midi.addEvent(juce::MidiMessage::noteOn(1, 60, 0.8f), 0);
+  buffer.clear();
+  processor.processBlock(buffer, midi);
+  CHECK_FALSE(isSilent(buffer));
+
+  midi.clear();
+  midi.addEvent(juce::MidiMessage::noteOff(1, 60), 0);
+  buffer.clear();
+  processor.processBlock(buffer, midi);
+  midi.clear();
+
+  // The release has to have finished within the reported tail
+  auto tailSamples = (int)std::ceil(processor.getTailLengthSeconds() * sampleRate);
+  CHECK(tailSamples > 0);
+
+  for (auto rendered = blockSize; rendered < tailSamples; rendered += blockSize)
+  {
+    buffer.clear();
+    processor.processBlock(buffer, midi);
+  }
+
+  buffer.clear();
+  processor.processBlock(buffer, midi);
+  CHECK(isSilent(buffer));
+}
+
+TEST_CASE("Offline renders last until the patch's release has rung out", "[processor][renderer]")
+{
+  SulfuricAudioProcessor processor;
+  for (auto* parameter : processor.getPatchParameters())
+    if (parameter->paramID == "release")
+      parameter->setValueNotifyingHost(parameter->convertTo0to1(6.0f));
+
+  juce::MidiMessageSequence sequence;
+  sequence.addEvent(juce::MidiMessage::noteOn(1, 60, 0.8f), 0.0);
+  sequence.addEvent(juce::MidiMessage::noteOff(1, 60), 0.5);
+  sequence.updateMatchedPairs();
+
+  SulfuricOfflineRenderer::Settings settings;
+  settings.sampleRate = sampleRate;
+
+  juce::AudioBuffer<float> audio;
+  REQUIRE(SulfuricOfflineRenderer::render(processor, sequence, settings, audio).wasOk());
+  CHECK(audio.getNumSamples() == (int)std::ceil((0.5 + processor.getTailLengthSeconds()) * sampleRate));
+  CHECK(processor.getTailLengthSeconds() == Approx(6.0).margin(0.01));
+
+  // Still sounding well past the old fixed second of tail
+  CHECK(audio.getMagnitude(0, (int)(2.5 * sampleRate), (int)sampleRate) > 0.0f);
+
+  settings.tailSeconds = 0.25;
+  REQUIRE(SulfuricOfflineRenderer::render(processor, sequence, settings, audio).wasOk());
+  CHECK(audio.getNumSamples() == (int)std::ceil(0.75 * sampleRate));
+}
+
+TEST_CASE("Double precision processBlock matches single precision", "[processor]")
+{
+  SulfuricAudioProcessor floatProcessor, doubleProcessor;
+  CHECK(doubleProcessor.supportsDoublePrecisionProcessing());
+
+  for (auto* processor : { &floatProcessor, &doubleProcessor })
+  {
+    processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor->prepareToPlay(sampleRate, blockSize);
+  }
+
+  juce::AudioBuffer<float> floatBuffer(2, blockSize);
+  juce::AudioBuffer<double> doubleBuffer(2, blockSize);
+
+  juce::MidiBuffer midi;
+  midi.addEvent(juce::MidiMessage::noteOn(1, 60, 0.8f), 10);
+  midi.addEvent(juce::MidiMessage::noteOn(1, 64, 0.8f), 100);
+
+  for (auto block = 0; block < 4; ++block)
+  {
+    floatBuffer.clear();
+    doubleBuffer.clear();
+    floatProcessor.processBlock(floatBuffer, midi);
+    doubleProcessor.processBlock(doubleBuffer, midi);
+    midi.clear();
+
+    for (auto channel = 0; channel < 2; ++channel)
+      for (auto i = 0; i < blockSize; ++i)
+        REQUIRE(doubleBuffer.getSample(channel, i) == Approx(floatBuffer.getSample(channel, i)).margin(1e-6));
+  }
+}
+
+
+TEST_CASE("Each enabled output bus plays its own MIDI channel", "[processor]")
+{
+  SulfuricAudioProcessor processor;
+  CHECK(processor.getBusCount(false) == SulfuricAudioProcessor::MAX_OUTPUT_BUSES);
+
+  auto layout = processor.getBusesLayout();
+  for (auto bus = 0; bus < 4; ++bus)
+    layout.outputBuses.getReference(bus) = juce::AudioChannelSet::stereo();
+  REQUIRE(processor.setBusesLayout(layout));
+
+  processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+  processor.prepareToPlay(sampleRate, blockSize);
+
+  juce::AudioBuffer<float> buffer(processor.getTotalNumOutputChannels(), blockSize);
+  REQUIRE(buffer.getNumChannels() == 8);
+
+  // Nothing on channel 3, so the third bus stays silent while the others render side by side
+  juce::MidiBuffer midi;
+  for (auto channel : { 1, 2, 4 })
+    midi.addEvent(juce::MidiMessage::noteOn(channel, 48 + channel, 0.8f), 0);
+
+  for (auto block = 0; block < 4; ++block)
+  {
+    buffer.clear();
+    processor.processBlock(buffer, midi);
+    midi.clear();
+
+    for (auto bus = 0; bus < 4; ++bus)
+      CHECK(isSilent(processor.getBusBuffer(buffer, false, bus)) == (bus == 2));
+  }
+}
+
+
+TEST_CASE("State saves in the binary format and still loads the old XML", "[processor][state]")
+{
+  SulfuricAudioProcessor processor;
+  auto& parameters = processor.getParameters();
+
+  for (auto* parameter : parameters)
+    parameter->setValueNotifyingHost(0.3f);
+
+  juce::MemoryBlock state;
+  processor.getStateInformation(state);
+  CHECK(SulfuricStateFormat::isBinaryState(state.getData(), (int)state.getSize()));
+  CHECK(state.getSize() == 8 + 8 * (size_t)parameters.size());
+
+  SulfuricAudioProcessor restored;
+  restored.setStateInformation(state.getData(), (int)state.getSize());
+
+  for (auto index = 0; index < parameters.size(); ++index)
+    CHECK(restored.getParameters()[index]->getValue() == Approx(parameters[index]->getValue()));
+
+  // What getStateInformation wrote before the binary format
+  juce::XmlElement xml("SulfuricParams");
+  auto* master = xml.createNewChildElement("PARAM");
+  master->setAttribute("id", "master");
+  master->setAttribute("value", 0.5);
+
+  juce::MemoryBlock xmlState;
+  juce::AudioProcessor::copyXmlToBinary(xml, xmlState);
+  CHECK_FALSE(SulfuricStateFormat::isBinaryState(xmlState.getData(), (int)xmlState.getSize()));
+
+  SulfuricAudioProcessor imported;
+  imported.setStateInformation(xmlState.getData(), (int)xmlState.getSize());
+  CHECK(*imported.masterParam == Approx(0.5f));
+}
+
+TEST_CASE("Parameter IDs hash to different values", "[state]")
+{
+  SulfuricAudioProcessor processor;
+  std::set<juce::uint32> hashes;
+
+  for (auto* parameter : processor.getParameters())
+    if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+      CHECK(hashes.insert(SulfuricStateFormat::hashParameterID(ranged->paramID)).second);
+}
+
+TEST_CASE("Instances share their tables", "[memory]")
+{
+  SulfuricAudioProcessor first;
+  first.prepareToPlay(48000.0, 512);
+  auto one = first.getMemoryFootprint();
+
+  SulfuricAudioProcessor second;
+  second.prepareToPlay(48000.0, 512);
+  auto two = second.getMemoryFootprint();
+
+  CHECK(one.sharedTables >= 2);
+  CHECK(two.sharedTables == one.sharedTables);
+  CHECK(two.sharedBytes == one.sharedBytes);
+  CHECK(two.instanceBytes == one.instanceBytes);
+}
+
+TEST_CASE("Voice engines wait for prepareToPlay and an enabled bus", "[memory][processor]")
+{
+  SulfuricAudioProcessor processor;
+  auto unprepared = processor.getMemoryFootprint().instanceBytes;
+
+  processor.prepareToPlay(sampleRate, blockSize);
+  auto oneBus = processor.getMemoryFootprint().instanceBytes;
+  CHECK(oneBus > unprepared);
+
+  // Preparing again with the same layout allocates nothing new
+  processor.prepareToPlay(sampleRate, blockSize);
+  CHECK(processor.getMemoryFootprint().instanceBytes == oneBus);
+
+  auto layout = processor.getBusesLayout();
+  layout.outputBuses.getReference(1) = juce::AudioChannelSet::stereo();
+  REQUIRE(processor.setBusesLayout(layout));
+  processor.prepareToPlay(sampleRate, blockSize);
+  CHECK(processor.getMemoryFootprint().instanceBytes > oneBus);
+}
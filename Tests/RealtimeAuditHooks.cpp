@@ -0,0 +1,223 @@
+// Only linked into the test executable, and only in SULFURIC_REALTIME_AUDIT builds.
+// Replaces the allocator, locks, sleeps, file I/O and raw system calls with versions that tell SulfuricRealtimeAudit first.
+
+#include <RealtimeAudit.h>
+
+#if SULFURIC_REALTIME_AUDIT
+
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+  #include <cstdarg>
+  #include <dlfcn.h>
+  #include <linux/futex.h>
+  #include <pthread.h>
+  #include <sys/syscall.h>
+  #include <time.h>
+  #include <unistd.h>
+
+extern "C"
+{
+  void* __libc_malloc(size_t);
+  void* __libc_calloc(size_t, size_t);
+  void* __libc_realloc(void*, size_t);
+  void* __libc_memalign(size_t, size_t);
+  void __libc_free(void*);
+}
+#endif
+
+namespace
+{
+#if defined(__GLIBC__)
+  // malloc itself is hooked below, operator new goes straight to glibc so each allocation is reported once
+  void* rawAllocate(size_t size) { return __libc_malloc(size); }
+  void* rawAllocateAligned(size_t size, size_t alignment) { return __libc_memalign(alignment, size); }
+  void rawFree(void* pointer) { __libc_free(pointer); }
+
+  template <typename Function>
+  Function getNext(Function, const char* name)
+  {
+    return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+  }
+#else
+  // Elsewhere only operator new and delete are caught
+  void* rawAllocate(size_t size) { return std::malloc(size); }
+  void* rawAllocateAligned(size_t size, size_t alignment) { return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment); }
+  void rawFree(void* pointer) { std::free(pointer); }
+#endif
+
+  void* allocate(size_t size, const char* what)
+  {
+    SulfuricRealtimeAudit::check(what);
+    return rawAllocate(size == 0 ? 1 : size);
+  }
+
+  void* allocateAligned(size_t size, std::align_val_t alignment, const char* what)
+  {
+    SulfuricRealtimeAudit::check(what);
+    return rawAllocateAligned(size == 0 ? 1 : size, (size_t)alignment);
+  }
+
+  void release(void* pointer, const char* what)
+  {
+    if (pointer == nullptr)
+      return;
+
+    SulfuricRealtimeAudit::check(what);
+    rawFree(pointer);
+  }
+
+  template <typename Pointer>
+  Pointer throwIfNull(Pointer pointer)
+  {
+    if (pointer == nullptr)
+      throw std::bad_alloc();
+    return pointer;
+  }
+}
+
+//==============================================================================
+void* operator new(size_t size) { return throwIfNull(allocate(size, "operator new")); }
+void* operator new[](size_t size) { return throwIfNull(allocate(size, "operator new[]")); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size, "operator new"); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size, "operator new[]"); }
+void* operator new(size_t size, std::align_val_t alignment) { return throwIfNull(allocateAligned(size, alignment, "operator new")); }
+void* operator new[](size_t size, std::align_val_t alignment) { return throwIfNull(allocateAligned(size, alignment, "operator new[]")); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment, "operator new"); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment, "operator new[]"); }
+
+void operator delete(void* pointer) noexcept { release(pointer, "operator delete"); }
+void operator delete[](void* pointer) noexcept { release(pointer, "operator delete[]"); }
+void operator delete(void* pointer, size_t) noexcept { release(pointer, "operator delete"); }
+void operator delete[](void* pointer, size_t) noexcept { release(pointer, "operator delete[]"); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { release(pointer, "operator delete"); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { release(pointer, "operator delete[]"); }
+void operator delete(void* pointer, std::align_val_t) noexcept { release(pointer, "operator delete"); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { release(pointer, "operator delete[]"); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { release(pointer, "operator delete"); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { release(pointer, "operator delete[]"); }
+
+//==============================================================================
+#if defined(__GLIBC__)
+extern "C"
+{
+  void* malloc(size_t size)
+  {
+    SulfuricRealtimeAudit::check("malloc");
+    return __libc_malloc(size);
+  }
+
+  void* calloc(size_t count, size_t size)
+  {
+    SulfuricRealtimeAudit::check("calloc");
+    return __libc_calloc(count, size);
+  }
+
+  void* realloc(void* pointer, size_t size)
+  {
+    SulfuricRealtimeAudit::check("realloc");
+    return __libc_realloc(pointer, size);
+  }
+
+  void* memalign(size_t alignment, size_t size)
+  {
+    SulfuricRealtimeAudit::check("memalign");
+    return __libc_memalign(alignment, size);
+  }
+
+  void* aligned_alloc(size_t alignment, size_t size)
+  {
+    SulfuricRealtimeAudit::check("aligned_alloc");
+    return __libc_memalign(alignment, size);
+  }
+
+  int posix_memalign(void** pointer, size_t alignment, size_t size)
+  {
+    SulfuricRealtimeAudit::check("posix_memalign");
+    *pointer = __libc_memalign(alignment, size);
+    return *pointer != nullptr ? 0 : ENOMEM;
+  }
+
+  void free(void* pointer)
+  {
+    if (pointer != nullptr)
+      SulfuricRealtimeAudit::check("free");
+    __libc_free(pointer);
+  }
+
+  // Uncontended or not, a lock can make the audio thread wait on another
+  int pthread_mutex_lock(pthread_mutex_t* mutex)
+  {
+    SulfuricRealtimeAudit::check("pthread_mutex_lock");
+    static auto next = getNext(&pthread_mutex_lock, "pthread_mutex_lock");
+    return next(mutex);
+  }
+
+  int pthread_rwlock_rdlock(pthread_rwlock_t* lock)
+  {
+    SulfuricRealtimeAudit::check("pthread_rwlock_rdlock");
+    static auto next = getNext(&pthread_rwlock_rdlock, "pthread_rwlock_rdlock");
+    return next(lock);
+  }
+
+  int pthread_rwlock_wrlock(pthread_rwlock_t* lock)
+  {
+    SulfuricRealtimeAudit::check("pthread_rwlock_wrlock");
+    static auto next = getNext(&pthread_rwlock_wrlock, "pthread_rwlock_wrlock");
+    return next(lock);
+  }
+
+  int nanosleep(const struct timespec* duration, struct timespec* remaining)
+  {
+    SulfuricRealtimeAudit::check("nanosleep");
+    static auto next = getNext(&nanosleep, "nanosleep");
+    return next(duration, remaining);
+  }
+
+  int usleep(useconds_t microseconds)
+  {
+    SulfuricRealtimeAudit::check("usleep");
+    static auto next = getNext(&usleep, "usleep");
+    return next(microseconds);
+  }
+
+  ssize_t read(int file, void* buffer, size_t size)
+  {
+    SulfuricRealtimeAudit::check("read");
+    static auto next = getNext(&read, "read");
+    return next(file, buffer, size);
+  }
+
+  ssize_t write(int file, const void* buffer, size_t size)
+  {
+    SulfuricRealtimeAudit::check("write");
+    static auto next = getNext(&write, "write");
+    return next(file, buffer, size);
+  }
+
+  // Where std::atomic's wait and notify end up. Waking a futex is the one accepted exception:
+  // it never waits for another thread, and it is how SulfuricWorkerPool wakes its workers.
+  long syscall(long number, ...)
+  {
+    // Six arguments whatever the call, like glibc's own syscall()
+    long arguments[6];
+    va_list list;
+    va_start(list, number);
+    for (auto& argument : arguments)
+      argument = va_arg(list, long);
+    va_end(list);
+
+    if (number != SYS_futex)
+      SulfuricRealtimeAudit::check("syscall");
+    else if ((arguments[1] & FUTEX_CMD_MASK) != FUTEX_WAKE)
+      SulfuricRealtimeAudit::check("futex wait");
+
+    static auto next = getNext(&syscall, "syscall");
+    return next(number, arguments[0], arguments[1], arguments[2], arguments[3], arguments[4], arguments[5]);
+  }
+}
+#endif
+
+#endif
@@ -0,0 +1,289 @@
+// Only does anything in SULFURIC_REALTIME_AUDIT builds, see Tests/RealtimeAuditHooks.cpp
+
+#include <PluginSynthesiser.h>
+#include <RealtimeAudit.h>
+#include <catch2/catch.hpp>
+
+#if SULFURIC_REALTIME_AUDIT
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace
+{
+  constexpr double sampleRate = 48000.0;
+  constexpr int blockSize = 256;
+
+  // Collects what the audit reports while it is alive, from whichever thread made the violation
+  class Violations
+  {
+  public:
+    Violations() { SulfuricRealtimeAudit::setHandler(record); }
+    ~Violations() { SulfuricRealtimeAudit::setHandler(nullptr); }
+
+    std::vector<std::string> take()
+    {
+      std::lock_guard<std::mutex> lock(getMutex());
+      std::vector<std::string> reports;
+      reports.swap(getReports());
+      return reports;
+    }
+
+    void checkNone()
+    {
+      auto reports = take();
+      for (auto& report : reports)
+        FAIL_CHECK(report);
+      CHECK(reports.empty());
+    }
+
+  private:
+    static std::mutex& getMutex()
+    {
+      static std::mutex mutex;
+      return mutex;
+    }
+
+    static std::vector<std::string>& getReports()
+    {
+      static std::vector<std::string> reports;
+      return reports;
+    }
+
+    static void record(const char* what, const juce::String& stackTrace)
+    {
+      std::lock_guard<std::mutex> lock(getMutex());
+      getReports().push_back(std::string(what) + " on the audio thread\n" + stackTrace.toStdString());
+    }
+  };
+
+  /**
+    A few seconds of a keyboard player on numChannels channels, built before any audio is rendered:
+    chords with varied timing and velocity, a mod wheel sweep, pitch bend, aftertouch, the sustain pedal,
+    program changes, an all notes off and one block with more events than the router has room for.
+  */
+  std::vector<juce::MidiBuffer> makePerformance(int numBlocks, int numChannels)
+  {
+    std::vector<juce::MidiBuffer> blocks((size_t)numBlocks);
+    juce::Random random(42);
+
+    for (auto block = 0; block < numBlocks; ++block)
+    {
+      auto& midi = blocks[(size_t)block];
+
+      for (auto channel = 1; channel <= numChannels; ++channel)
+      {
+        auto root = 36 + ((block / 8) * 5 + channel * 7) % 36;
+
+        if (block % 8 == 0)
+          for (auto note = 0; note < 4; ++note)
+            midi.addEvent(juce::MidiMessage::noteOn(channel, root + note * 4, 0.3f + random.nextFloat() * 0.7f), random.nextInt(blockSize));
+
+        if (block % 8 == 5 && block >= 8)
+          for (auto note = 0; note < 4; ++note)
+            midi.addEvent(juce::MidiMessage::noteOff(channel, root + note * 4), random.nextInt(blockSize));
+
+        for (auto position = 0; position < blockSize; position += 64)
+          midi.addEvent(juce::MidiMessage::controllerEvent(channel, 1, (block + position) % 128), position);
+
+        midi.addEvent(juce::MidiMessage::pitchWheel(channel, 8192 + (block % 16) * 256), random.nextInt(blockSize));
+        midi.addEvent(juce::MidiMessage::channelPressureChange(channel, block % 128), random.nextInt(blockSize));
+
+        if (block == 40)
+          midi.addEvent(juce::MidiMessage::controllerEvent(channel, 64, 127), 10);
+        if (block == 80)
+          midi.addEvent(juce::MidiMessage::controllerEvent(channel, 64, 0), 200);
+        if (block == 100)
+          midi.addEvent(juce::MidiMessage::programChange(channel, 3), 0);
+        if (block == 150)
+          midi.addEvent(juce::MidiMessage::allNotesOff(channel), 128);
+      }
+
+      // Past what SulfuricAudioProcessor preallocates for routing, so it scans the host's buffer instead
+      if (block == 120)
+        for (auto event = 0; event < 3000; ++event)
+          midi.addEvent(juce::MidiMessage::controllerEvent(1 + event % numChannels, 2, event % 128), event % blockSize);
+    }
+
+    return blocks;
+  }
+
+  void enableBuses(SulfuricAudioProcessor& processor, int numBuses)
+  {
+    auto layout = processor.getBusesLayout();
+    for (auto bus = 0; bus < layout.outputBuses.size(); ++bus)
+      layout.outputBuses.getReference(bus) = bus < numBuses ? juce::AudioChannelSet::stereo() : juce::AudioChannelSet::disabled();
+    processor.setBusesLayout(layout);
+  }
+
+  // Moves some parameters between blocks, the way host automation would from the message thread
+  void automate(SulfuricAudioProcessor& processor, int block)
+  {
+    auto& parameters = processor.getParameters();
+    for (auto index = 0; index < parameters.size(); ++index)
+      if ((block + index) % 7 == 0)
+        parameters[index]->setValueNotifyingHost((float)((block * 13 + index * 5) % 100) / 100.0f);
+  }
+
+  template <typename SampleType>
+  void perform(SulfuricAudioProcessor& processor, const std::vector<juce::MidiBuffer>& performance, bool shouldAutomate)
+  {
+    juce::AudioBuffer<SampleType> buffer(processor.getTotalNumOutputChannels(), blockSize);
+
+    for (size_t block = 0; block < performance.size(); ++block)
+    {
+      if (shouldAutomate)
+        automate(processor, (int)block);
+
+      // processBlock doesn't touch the MIDI, so the prebuilt buffers can go in as they are
+      auto& midi = const_cast<juce::MidiBuffer&>(performance[block]);
+      processor.processBlock(buffer, midi);
+    }
+  }
+}
+
+TEST_CASE("Real-time audit reports what it should, where it should", "[realtime]")
+{
+  Violations violations;
+  auto before = SulfuricRealtimeAudit::getNumViolations();
+
+  std::vector<int> outside(100);
+  std::mutex mutex;
+  { std::lock_guard<std::mutex> lock(mutex); }
+  CHECK(SulfuricRealtimeAudit::getNumViolations() == before);
+
+  {
+    SULFURIC_REALTIME_SCOPE();
+    CHECK(SulfuricRealtimeAudit::isInside());
+
+    std::vector<int> inside(100);
+    { std::lock_guard<std::mutex> lock(mutex); }
+  }
+
+  CHECK_FALSE(SulfuricRealtimeAudit::isInside());
+
+  // Allocating, locking, freeing
+  CHECK(SulfuricRealtimeAudit::getNumViolations() == before + 3);
+  auto reports = violations.take();
+  REQUIRE(reports.size() == 3);
+  CHECK(reports[1].find("pthread_mutex_lock") == 0);
+}
+
+#if defined(__GLIBC__)
+TEST_CASE("Real-time audit lets futex wakes through, but not waits", "[realtime]")
+{
+  Violations violations;
+  std::atomic<int> flag{ 0 };
+
+  // Someone to wake, or notify_all may not make the call at all
+  std::thread waiter([&flag] { flag.wait(0); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  {
+    // How SulfuricWorkerPool wakes its workers, it never waits for anyone
+    SULFURIC_REALTIME_SCOPE();
+    flag.store(1);
+    flag.notify_all();
+  }
+
+  waiter.join();
+  violations.checkNone();
+
+  {
+    // Returns at once since the value doesn't match, but could have slept
+    SULFURIC_REALTIME_SCOPE();
+    syscall(SYS_futex, &flag, FUTEX_WAIT_PRIVATE, 0, nullptr);
+  }
+
+  auto reports = violations.take();
+  REQUIRE(reports.size() == 1);
+  CHECK(reports[0].find("futex wait") == 0);
+}
+#endif
+
+TEST_CASE("Voice engine renders without allocating, locking or blocking", "[realtime][engine]")
+{
+  SulfuricWorkerPool pool(3);
+  SulfuricVoiceEngine engine(SulfuricAudioProcessor::MAX_POLYPHONY);
+  engine.setCurrentPlaybackSampleRate(sampleRate);
+  engine.setWorkerPool(&pool);
+  engine.setParallelThreshold(8);
+
+  auto performance = makePerformance(200, 16);
+  juce::AudioBuffer<float> buffer(2, blockSize);
+
+  Violations violations;
+
+  for (auto& midi : performance)
+  {
+    buffer.clear();
+    engine.renderNextBlock(buffer, midi, 0, blockSize);
+  }
+
+  violations.checkNone();
+}
+
+TEST_CASE("processBlock is real-time safe through a whole performance", "[realtime][processor]")
+{
+  for (auto numBuses : { 1, 4 })
+  {
+    SulfuricAudioProcessor processor;
+    enableBuses(processor, numBuses);
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    // As if the editor were open, so the scope is fed too
+    processor.getScopeFeed().addViewer();
+
+    auto performance = makePerformance(200, numBuses == 1 ? 1 : 8);
+
+    Violations violations;
+
+    perform<float>(processor, performance, true);
+    perform<double>(processor, performance, false);
+
+    INFO("buses: " << numBuses);
+    violations.checkNone();
+  }
+}
+
+TEST_CASE("processBlock is real-time safe with one bus spread over the worker pool", "[realtime][processor][workers]")
+{
+  SulfuricAudioProcessor processor;
+  processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+  processor.prepareToPlay(sampleRate, blockSize);
+  for (auto* parameter : processor.getParameters())
+    if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter); ranged != nullptr && ranged->paramID == "polyphony")
+      ranged->setValueNotifyingHost(1.0f);
+
+  // Enough held notes to pass the parallel threshold
+  std::vector<juce::MidiBuffer> performance(100);
+  for (auto note = 0; note < 96; ++note)
+    performance[0].addEvent(juce::MidiMessage::noteOn(1, 16 + note, 0.5f), note);
+  performance[60].addEvent(juce::MidiMessage::allNotesOff(1), 0);
+
+  Violations violations;
+  perform<float>(processor, performance, false);
+  violations.checkNone();
+}
+
+#else
+
+TEST_CASE("Real-time safety is only audited in SULFURIC_REALTIME_AUDIT builds", "[realtime]")
+{
+  // Shows up in the results instead of the real-time tests silently not existing
+  WARN("Skipped, configure with -DSULFURIC_REALTIME_AUDIT=ON to audit processBlock");
+  SUCCEED();
+}
+
+#endif
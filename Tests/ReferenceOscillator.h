@@ -0,0 +1,138 @@
+// One oscillator voice rendered on its own, the way voices worked before SulfuricVoiceBank.
+// Not part of the plugin: the tests check the bank against it and the benchmarks measure
+// the bank and the quality modes against it.
+
+#pragma once
+
+#include <Oscillator.h>
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numbers>
+
+class ReferenceOscillator
+{
+public:
+  void setQuality(OscillatorQuality newQuality) noexcept
+  {
+    if (newQuality == quality)
+      return;
+
+    auto cycles = getPhaseInCycles();
+    quality = newQuality;
+    setPhaseInCycles(cycles);
+  }
+
+  OscillatorQuality getQuality() const noexcept { return quality; }
+
+  void setFrequency(double frequency, double sampleRate) noexcept
+  {
+    angleDelta = frequency / sampleRate * 2.0 * std::numbers::pi;
+    rotationRe = std::cos(angleDelta);
+    rotationIm = std::sin(angleDelta);
+
+    phaseIncrement = SulfuricWavetable::incrementForFrequency(frequency, sampleRate);
+    table = wavetable->getLevel(wavetable->getLevelForIncrement(phaseIncrement));
+  }
+
+  // Restarts the waveform at phase 0
+  void reset() noexcept
+  {
+    angle = 0.0;
+    re = 1.0;
+    im = 0.0;
+    phase = 0;
+  }
+
+  // Overwrites output with the next numSamples samples
+  void process(float* output, int numSamples) noexcept
+  {
+    switch (quality)
+    {
+      case OscillatorQuality::exact:
+        for (auto i = 0; i < numSamples; ++i)
+        {
+          output[i] = (float)std::sin(angle);
+          angle += angleDelta;
+        }
+
+        // Keep the angle small so it doesn't lose precision over long notes
+        angle = std::fmod(angle, 2.0 * std::numbers::pi);
+        break;
+
+      case OscillatorQuality::phasor:
+      {
+        auto r = re, i = im;
+        for (auto n = 0; n < numSamples; ++n)
+        {
+          output[n] = (float)i;
+          auto nextRe = r * rotationRe - i * rotationIm;
+          i = r * rotationIm + i * rotationRe;
+          r = nextRe;
+        }
+
+        // Rounding makes the magnitude drift, pull it back onto the unit circle once per block
+        auto correction = 1.5 - 0.5 * (r * r + i * i);
+        re = r * correction;
+        im = i * correction;
+        break;
+      }
+
+      case OscillatorQuality::cubic:
+        for (auto i = 0; i < numSamples; ++i)
+        {
+          output[i] = SulfuricWavetable::readCubic(table, phase);
+          phase += phaseIncrement;
+        }
+        break;
+
+      case OscillatorQuality::linear:
+        for (auto i = 0; i < numSamples; ++i)
+        {
+          output[i] = SulfuricWavetable::readLinear(table, phase);
+          phase += phaseIncrement;
+        }
+        break;
+    }
+  }
+
+private:
+  double getPhaseInCycles() const noexcept
+  {
+    switch (quality)
+    {
+      case OscillatorQuality::exact:
+        return angle / (2.0 * std::numbers::pi);
+      case OscillatorQuality::phasor:
+        return std::atan2(im, re) / (2.0 * std::numbers::pi);
+      case OscillatorQuality::cubic:
+      case OscillatorQuality::linear:
+      default:
+        return (double)phase / 4294967296.0;
+    }
+  }
+
+  void setPhaseInCycles(double cycles) noexcept
+  {
+    cycles -= std::floor(cycles);
+
+    angle = cycles * 2.0 * std::numbers::pi;
+    re = std::cos(angle);
+    im = std::sin(angle);
+    phase = (uint32_t)(int64_t)(cycles * 4294967296.0);
+  }
+
+  OscillatorQuality quality = OscillatorQuality::cubic;
+  std::shared_ptr<const SulfuricWavetable> wavetable = SulfuricWavetable::getSine();
+  const float* table = wavetable->getLevel(0);
+
+  // exact
+  double angle = 0.0, angleDelta = 0.0;
+
+  // phasor, (re, im) rotates by (rotationRe, rotationIm) every sample
+  double re = 1.0, im = 0.0, rotationRe = 1.0, rotationIm = 0.0;
+
+  // cubic, linear
+  uint32_t phase = 0, phaseIncrement = 0;
+};
@@ -0,0 +1,92 @@
+#include <ScopeFeed.h>
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+TEST_CASE("Scope feed stays off without a viewer", "[scope]")
+{
+  SulfuricScopeFeed feed;
+  feed.prepare(48000.0);
+
+  juce::AudioBuffer<float> buffer(2, 256);
+  buffer.clear();
+  buffer.setSample(0, 0, 1.0f);
+
+  CHECK_FALSE(feed.isActive());
+  feed.push(buffer);
+
+  std::vector<float> pulled(1024);
+  CHECK(feed.pull(pulled.data(), (int)pulled.size()) == 0);
+
+  feed.addViewer();
+  feed.push(buffer);
+  CHECK(feed.pull(pulled.data(), (int)pulled.size()) == 256);
+  CHECK(pulled[0] == Approx(0.5f));
+
+  feed.removeViewer();
+  feed.push(buffer);
+  CHECK(feed.pull(pulled.data(), (int)pulled.size()) == 0);
+}
+
+TEST_CASE("Scope feed mixes to mono and averages high rates down", "[scope]")
+{
+  SulfuricScopeFeed feed;
+  feed.prepare(96000.0);
+  feed.addViewer();
+  CHECK(feed.getFeedSampleRate() == Approx(48000.0));
+
+  // Odd block sizes, so a decimation window straddles two blocks
+  juce::AudioBuffer<double> buffer(2, 5);
+  std::vector<float> expected;
+  auto ramp = 0;
+
+  for (auto block = 0; block < 4; ++block)
+  {
+    for (auto i = 0; i < buffer.getNumSamples(); ++i, ++ramp)
+    {
+      buffer.setSample(0, i, ramp);
+      buffer.setSample(1, i, -0.5 * ramp);
+    }
+
+    feed.push(buffer);
+  }
+
+  // Pairs of 0.25 * ramp
+  for (auto pair = 0; pair < ramp / 2; ++pair)
+    expected.push_back(0.25f * (float)(pair * 2 + pair * 2 + 1) / 2.0f);
+
+  std::vector<float> pulled(64);
+  REQUIRE(feed.pull(pulled.data(), (int)pulled.size()) == (int)expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+    CHECK(pulled[i] == Approx(expected[i]));
+
+  feed.prepare(44100.0);
+  CHECK(feed.getFeedSampleRate() == Approx(44100.0));
+}
+
+TEST_CASE("Scope feed drops what a slow viewer has no room for", "[scope]")
+{
+  SulfuricScopeFeed feed;
+  feed.prepare(48000.0);
+  feed.addViewer();
+
+  juce::AudioBuffer<float> buffer(1, 4096);
+  for (auto block = 0; block < 8; ++block)
+  {
+    for (auto i = 0; i < buffer.getNumSamples(); ++i)
+      buffer.setSample(0, i, (float)block);
+
+    feed.push(buffer);
+  }
+
+  // The oldest samples survive, the ones that arrived to a full FIFO are counted
+  std::vector<float> pulled(SulfuricScopeFeed::CAPACITY);
+  auto numPulled = feed.pull(pulled.data(), (int)pulled.size());
+  CHECK(numPulled == SulfuricScopeFeed::CAPACITY - 1);
+  CHECK(pulled[0] == 0.0f);
+  CHECK(feed.getNumDropped() == (juce::uint64)(8 * 4096 - numPulled));
+
+  feed.push(buffer);
+  CHECK(feed.pull(pulled.data(), (int)pulled.size()) == 4096);
+  CHECK(pulled[0] == 7.0f);
+}
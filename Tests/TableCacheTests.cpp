@@ -0,0 +1,64 @@
+#include <Oscillator.h>
+#include <TableCache.h>
+#include <VoiceBank.h>
+#include <catch2/catch.hpp>
+
+namespace
+{
+  struct CountingTable
+  {
+    explicit CountingTable(int& builds) { ++builds; }
+    size_t getMemoryUsage() const noexcept { return 1000; }
+  };
+}
+
+TEST_CASE("Table cache builds a table once and shares it", "[tables]")
+{
+  auto builds = 0;
+  auto build = [&] { return CountingTable(builds); };
+  auto before = SulfuricTableCache::getStatistics();
+
+  auto first = SulfuricTableCache::get<CountingTable>("test/counting", build);
+  auto second = SulfuricTableCache::get<CountingTable>("test/counting", build);
+
+  CHECK(first == second);
+  CHECK(builds == 1);
+
+  auto during = SulfuricTableCache::getStatistics();
+  CHECK(during.numTables == before.numTables + 1);
+  CHECK(during.bytes == before.bytes + 1000);
+
+  // Let go by everyone, so it is freed and built again next time
+  first.reset();
+  second.reset();
+  CHECK(SulfuricTableCache::getStatistics().numTables == before.numTables);
+
+  auto third = SulfuricTableCache::get<CountingTable>("test/counting", build);
+  CHECK(builds == 2);
+
+  // Different keys are different tables
+  auto other = SulfuricTableCache::get<CountingTable>("test/counting@48000", build);
+  CHECK(other != third);
+  CHECK(builds == 3);
+}
+
+TEST_CASE("Voice banks share one sine table", "[tables]")
+{
+  SulfuricVoiceBank a(16), b(256);
+  auto withBanks = SulfuricTableCache::getStatistics();
+
+  // The banks' own storage grows with their voices, the table doesn't
+  SulfuricVoiceBank c(256);
+  CHECK(SulfuricTableCache::getStatistics().bytes == withBanks.bytes);
+  CHECK(c.getMemoryUsage() > a.getMemoryUsage());
+  CHECK(SulfuricWavetable::getSine()->getMemoryUsage() > 0);
+}
+
+TEST_CASE("Note table matches equal temperament", "[tables]")
+{
+  auto notes = SulfuricNoteTable::getShared();
+  CHECK(notes->getFrequency(69) == Approx(440.0));
+  CHECK(notes->getFrequency(60) == Approx(261.6256));
+  CHECK(notes->getFrequency(81) == Approx(880.0));
+  CHECK(notes == SulfuricNoteTable::getShared());
+}
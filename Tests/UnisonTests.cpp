@@ -0,0 +1,204 @@
+#include <VoiceBank.h>
+#include <VoiceEngine.h>
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+  constexpr double sampleRate = 48000.0;
+
+  struct Stereo
+  {
+    std::vector<float> left, right;
+  };
+
+  Stereo render(SulfuricVoiceBank& bank, int numSamples)
+  {
+    Stereo output{ std::vector<float>((size_t)numSamples, 0.0f), std::vector<float>((size_t)numSamples, 0.0f) };
+    bank.render(output.left.data(), output.right.data(), numSamples);
+    return output;
+  }
+
+  float rms(const std::vector<float>& samples)
+  {
+    auto sum = 0.0;
+    for (auto sample : samples)
+      sum += sample * sample;
+    return (float)std::sqrt(sum / (double)samples.size());
+  }
+
+  // Counts sign changes, which for a sum of sines near one pitch tracks that pitch
+  int countZeroCrossings(const std::vector<float>& samples)
+  {
+    auto crossings = 0;
+    for (size_t i = 1; i < samples.size(); ++i)
+      crossings += (samples[i - 1] < 0.0f) != (samples[i] < 0.0f);
+    return crossings;
+  }
+}
+
+TEST_CASE("A single unison voice renders the usual single oscillator", "[unison][voicebank]")
+{
+  auto quality = GENERATE(OscillatorQuality::exact, OscillatorQuality::phasor, OscillatorQuality::cubic, OscillatorQuality::linear);
+
+  SulfuricVoiceBank plain(8), unison(8);
+  unison.setUnison({ 1, 50.0f, 1.0f });
+
+  for (auto* bank : { &plain, &unison })
+  {
+    bank->setSampleRate(sampleRate);
+    bank->setQuality(quality);
+    bank->startVoice(3, 440.0, 0.8f);
+  }
+
+  auto expected = render(plain, 1000);
+  auto actual = render(unison, 1000);
+
+  CHECK(actual.left == expected.left);
+  CHECK(actual.right == expected.left);
+  CHECK_FALSE(unison.isStereo());
+}
+
+TEST_CASE("Unison copies keep the pitch and the loudness, and spread across the channels", "[unison][voicebank]")
+{
+  auto quality = GENERATE(OscillatorQuality::exact, OscillatorQuality::phasor, OscillatorQuality::cubic, OscillatorQuality::linear);
+  auto voices = GENERATE(2, 7, SulfuricVoiceBank::MAX_UNISON);
+
+  SulfuricVoiceBank single(4), centred(4), spread(4);
+  centred.setUnison({ voices, 30.0f, 0.0f });
+  spread.setUnison({ voices, 30.0f, 1.0f });
+
+  for (auto* bank : { &single, &centred, &spread })
+  {
+    bank->setSampleRate(sampleRate);
+    bank->setQuality(quality);
+    bank->startVoice(1, 440.0, 1.0f);
+
+    // Past the attack
+    render(*bank, 4800);
+  }
+
+  // Evenly detuned copies line up again every 1 / (their spacing in Hz), about a second for 16 of them
+  auto reference = render(single, 96000);
+  auto middle = render(centred, 96000);
+  auto wide = render(spread, 96000);
+
+  CHECK_FALSE(centred.isStereo());
+  CHECK(spread.isStereo());
+  CHECK(middle.left == middle.right);
+
+  // The copies beat against each other, on average they are about as loud as one oscillator
+  CHECK(rms(middle.left) == Approx(rms(reference.left)).epsilon(0.35));
+
+  // 30 cents either way still crosses zero at about 440 Hz
+  CHECK(countZeroCrossings(middle.left) == Approx(countZeroCrossings(reference.left)).epsilon(0.02));
+
+  // Spread, the channels differ but neither gets louder than in the centre
+  auto difference = 0.0f;
+  for (size_t i = 0; i < wide.left.size(); ++i)
+    difference = std::max(difference, std::abs(wide.left[i] - wide.right[i]));
+
+  CHECK(difference > 0.05f);
+  CHECK(rms(wide.left) < rms(middle.left) * 1.2f);
+  CHECK(rms(wide.right) < rms(middle.right) * 1.2f);
+}
+
+TEST_CASE("Unison folds down to the average of its channels in mono", "[unison][voicebank]")
+{
+  SulfuricVoiceBank stereo(8), mono(8);
+
+  for (auto* bank : { &stereo, &mono })
+  {
+    bank->setSampleRate(sampleRate);
+    bank->setUnison({ 9, 40.0f, 0.7f });
+
+    SulfuricFilter::Parameters filter;
+    filter.mode = SulfuricFilter::Mode::lowPass;
+    filter.cutoffHz = 2000.0f;
+    filter.resonance = 0.5f;
+    bank->setFilter(filter);
+
+    bank->startVoice(0, 220.0, 0.9f);
+    bank->startVoice(5, 330.0, 0.6f);
+  }
+
+  auto both = render(stereo, 3000);
+
+  std::vector<float> folded(3000, 0.0f);
+  mono.render(folded.data(), (int)folded.size());
+
+  for (size_t i = 0; i < folded.size(); ++i)
+    REQUIRE(folded[i] == Approx(0.5f * (both.left[i] + both.right[i])).margin(1e-5));
+}
+
+TEST_CASE("Unison shares the voice's envelope and can change mid-note", "[unison][voicebank]")
+{
+  SulfuricVoiceBank bank(8);
+  bank.setSampleRate(sampleRate);
+  bank.setEnvelope({ 0.001f, 0.01f, 1.0f, 0.01f });
+  bank.setUnison({ 8, 0.0f, 0.0f });
+  bank.startVoice(2, 110.0, 1.0f);
+  render(bank, 2000);
+
+  // The copies keep their phases while they are retuned, so sweeping the detune and spread doesn't click
+  auto previous = render(bank, 1).left[0];
+  auto largestStep = 0.0f;
+
+  for (auto step = 0; step <= 100; ++step)
+  {
+    bank.setUnison({ 8, 0.5f * (float)step, 0.01f * (float)step });
+
+    for (auto sample : render(bank, SulfuricVoiceBank::RENDER_CHUNK).left)
+    {
+      largestStep = std::max(largestStep, std::abs(sample - previous));
+      previous = sample;
+    }
+  }
+
+  // A 110 Hz sine at full level moves less than 0.015 a sample
+  CHECK(largestStep < 0.05f);
+
+  // More copies, fewer, and back to one oscillator. New copies start wherever they start, but nothing runs away.
+  for (auto voices : { 16, 3, 1, 12 })
+  {
+    bank.setUnison({ voices, 25.0f, 1.0f });
+
+    for (auto sample : render(bank, 2000).left)
+    {
+      REQUIRE(std::isfinite(sample));
+      REQUIRE(std::abs(sample) < 4.0f);
+    }
+  }
+
+  // Releasing the voice releases every copy at once, and the bank frees it when the release is over
+  bank.stopVoice(2, true);
+  render(bank, 480 + SulfuricVoiceBank::RENDER_CHUNK);
+
+  CHECK_FALSE(bank.isVoiceActive(2));
+  CHECK(render(bank, 64).left == std::vector<float>(64, 0.0f));
+}
+
+TEST_CASE("Voice engine renders a spread unison in stereo and anything else in mono", "[unison][engine]")
+{
+  auto numChannels = GENERATE(1, 2, 3);
+
+  SulfuricVoiceEngine engine(8);
+  engine.setCurrentPlaybackSampleRate(sampleRate);
+  engine.setUnison({ 6, 20.0f, 1.0f });
+
+  juce::AudioBuffer<float> buffer(numChannels, 1000);
+  buffer.clear();
+
+  juce::MidiBuffer midi;
+  midi.addEvent(juce::MidiMessage::noteOn(1, 60, 0.8f), 0);
+  CHECK(engine.renderNextBlock(buffer, midi, 0, 1000));
+
+  auto differs = false;
+  for (auto i = 0; i < 1000; ++i)
+    differs |= buffer.getSample(0, i) != buffer.getSample(numChannels - 1, i);
+
+  // A third channel gets the left again
+  CHECK(differs == (numChannels == 2));
+}
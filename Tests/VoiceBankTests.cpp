@@ -0,0 +1,193 @@
+#include <VoiceBank.h>
+#include "ReferenceOscillator.h"
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+  // Attack, decay, sustain below full and a release, so every segment gets exercised
+  SulfuricEnvelope::Parameters testEnvelope()
+  {
+    SulfuricEnvelope::Parameters parameters;
+    parameters.attackSeconds = 0.005f;
+    parameters.decaySeconds = 0.05f;
+    parameters.sustainLevel = 0.6f;
+    parameters.releaseSeconds = 0.1f;
+    return parameters;
+  }
+
+  // A per-voice render in double precision, stepping the envelope one sample at a time
+  struct ReferenceVoice
+  {
+    enum Stage { attack, decay, sustain, release, finished };
+
+    ReferenceOscillator oscillator;
+    SulfuricEnvelope::Parameters envelope;
+    double sampleRate = 44100.0, level = 0.0, releaseStart = 0.0, x = 1.0, ratio = 1.0;
+    int stage = finished, samplesLeft = 0;
+
+    void start(double frequency, double newSampleRate, float velocity, OscillatorQuality quality, const SulfuricEnvelope::Parameters& parameters)
+    {
+      sampleRate = newSampleRate;
+      envelope = parameters;
+      oscillator.setQuality(quality);
+      oscillator.setFrequency(frequency, sampleRate);
+      oscillator.reset();
+      level = velocity;
+      enter(attack);
+    }
+
+    void stop()
+    {
+      if (stage == release || stage == finished)
+        return;
+
+      releaseStart = getGain();
+      enter(release);
+    }
+
+    void enter(int newStage)
+    {
+      stage = newStage;
+      x = 1.0;
+
+      auto seconds = stage == attack ? envelope.attackSeconds : stage == decay ? envelope.decaySeconds : envelope.releaseSeconds;
+      samplesLeft = stage == sustain || stage == finished ? -1 : SulfuricEnvelope::makeSegment(seconds, sampleRate).length;
+      ratio = samplesLeft > 0 ? std::pow(SulfuricEnvelope::FLOOR, 1.0 / samplesLeft) : 0.0;
+
+      if (samplesLeft == 0)
+        enter(stage == release ? finished : stage + 1);
+    }
+
+    double getGain() const
+    {
+      switch (stage)
+      {
+      case attack: return level * (1.0 - x);
+      case decay: return level * (envelope.sustainLevel + (1.0 - envelope.sustainLevel) * x);
+      case sustain: return level * envelope.sustainLevel;
+      case release: return releaseStart * x;
+      default: return 0.0;
+      }
+    }
+
+    void render(float* output, int numSamples)
+    {
+      std::vector<float> samples((size_t)numSamples);
+      oscillator.process(samples.data(), numSamples);
+
+      for (auto i = 0; i < numSamples && stage != finished; ++i)
+      {
+        output[i] += (float)(samples[(size_t)i] * getGain());
+        x *= ratio;
+
+        if (--samplesLeft == 0)
+          enter(stage == release ? finished : stage + 1);
+      }
+    }
+  };
+}
+
+TEST_CASE("Voice bank matches per-voice rendering", "[voicebank]")
+{
+  constexpr double sampleRate = 48000.0;
+  constexpr int numVoices = 16, blockSize = 480, length = 48000;
+
+  auto quality = GENERATE(OscillatorQuality::exact, OscillatorQuality::phasor, OscillatorQuality::cubic, OscillatorQuality::linear);
+
+  SulfuricVoiceBank bank(numVoices);
+  bank.setSampleRate(sampleRate);
+  bank.setQuality(quality);
+  bank.setEnvelope(testEnvelope());
+
+  std::vector<ReferenceVoice> reference(numVoices);
+  std::vector<float> bankOutput(length, 0.0f), referenceOutput(length, 0.0f);
+
+  for (auto voice = 0; voice < numVoices; ++voice)
+  {
+    auto frequency = 440.0 * std::pow(2.0, (40 + voice * 3 - 69) / 12.0);
+    bank.startVoice(voice, frequency, 0.5f);
+    reference[(size_t)voice].start(frequency, sampleRate, 0.5f, quality, testEnvelope());
+  }
+
+  for (auto position = 0; position < length; position += blockSize)
+  {
+    // Release every other voice halfway through
+    if (position == length / 2)
+    {
+      for (auto voice = 0; voice < numVoices; voice += 2)
+      {
+        bank.stopVoice(voice, true);
+        reference[(size_t)voice].stop();
+      }
+    }
+
+    bank.render(bankOutput.data() + position, blockSize);
+    for (auto& voice : reference)
+      voice.render(referenceOutput.data() + position, blockSize);
+  }
+
+  // The bank runs in float and plays the pitch its 32 bit phase increment can represent
+  for (auto i = 0; i < length; ++i)
+    REQUIRE(bankOutput[(size_t)i] == Approx(referenceOutput[(size_t)i]).margin(1e-4));
+
+  CHECK(bank.getNumActiveVoices() == numVoices / 2);
+}
+
+TEST_CASE("Voice bank frees voices", "[voicebank]")
+{
+  SulfuricVoiceBank bank(4);
+  bank.setSampleRate(44100.0);
+  std::vector<float> output(4096, 0.0f);
+
+  bank.startVoice(0, 440.0, 1.0f);
+  bank.startVoice(1, 220.0, 1.0f);
+  CHECK(bank.getNumActiveVoices() == 2);
+
+  bank.stopVoice(0, false);
+  CHECK_FALSE(bank.isVoiceActive(0));
+
+  // The default 15 ms release is long gone after 4096 samples
+  bank.stopVoice(1, true);
+  CHECK(bank.isVoiceReleasing(1));
+  bank.render(output.data(), (int)output.size());
+  CHECK_FALSE(bank.isVoiceActive(1));
+  CHECK(bank.getNumActiveVoices() == 0);
+}
+
+TEST_CASE("Envelope times do not depend on the sample rate", "[voicebank]")
+{
+  auto sampleRate = GENERATE(22050.0, 44100.0, 96000.0);
+
+  SulfuricVoiceBank bank(1);
+  bank.setSampleRate(sampleRate);
+  bank.setEnvelope(testEnvelope());
+
+  // Render one sample at a time, so the point the voice finishes is exact
+  auto renderSeconds = [&](double seconds)
+  {
+    auto peak = 0.0f;
+    for (auto i = 0; i < (int)std::lround(seconds * sampleRate) && bank.isVoiceActive(0); ++i)
+    {
+      auto sample = 0.0f;
+      bank.render(&sample, 1);
+      peak = std::max(peak, std::abs(sample));
+    }
+    return peak;
+  };
+
+  bank.startVoice(0, 1000.0, 1.0f);
+  CHECK(renderSeconds(0.005) > 0.95f);
+
+  // Decayed down to the sustain level
+  renderSeconds(0.2);
+  CHECK(renderSeconds(0.02) == Approx(0.6f).margin(0.01));
+
+  bank.stopVoice(0, true);
+  renderSeconds(0.099);
+  CHECK(bank.isVoiceActive(0));
+  renderSeconds(0.002);
+  CHECK_FALSE(bank.isVoiceActive(0));
+}
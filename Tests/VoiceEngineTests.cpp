@@ -0,0 +1,297 @@
+#include <VoiceEngine.h>
+#include <catch2/catch.hpp>
+
+namespace
+{
+  // Renders until every release has run out
+  void renderUntilIdle(SulfuricVoiceEngine& engine)
+  {
+    juce::AudioBuffer<float> buffer(1, 512);
+    juce::MidiBuffer midi;
+
+    for (auto block = 0; block < 100 && engine.getNumActiveVoices() > 0; ++block)
+      engine.renderNextBlock(buffer, midi, 0, buffer.getNumSamples());
+  }
+}
+
+TEST_CASE("Voice engine steals the voice released longest ago, then the oldest held one", "[engine]")
+{
+  SulfuricVoiceEngine engine(4);
+  engine.setCurrentPlaybackSampleRate(48000.0);
+
+  for (auto note = 60; note < 64; ++note)
+    engine.noteOn(1, note, 0.8f);
+
+  CHECK(engine.getNumActiveVoices() == 4);
+  CHECK(engine.getVoiceForNote(1, 60) == 0);
+  CHECK(engine.getVoiceForNote(1, 63) == 3);
+
+  engine.noteOff(1, 61, true);
+  engine.noteOff(1, 62, true);
+  CHECK(engine.getVoiceForNote(1, 61) == -1);
+
+  engine.noteOn(1, 64, 0.8f);
+  CHECK(engine.getVoiceForNote(1, 64) == 1);
+
+  engine.noteOn(1, 65, 0.8f);
+  CHECK(engine.getVoiceForNote(1, 65) == 2);
+
+  // Nothing released left, so the oldest held note goes
+  engine.noteOn(1, 66, 0.8f);
+  CHECK(engine.getVoiceForNote(1, 66) == 0);
+  CHECK(engine.getVoiceForNote(1, 60) == -1);
+  CHECK(engine.getNumActiveVoices() == 4);
+}
+
+TEST_CASE("Voice engine keeps to the polyphony it is given", "[engine]")
+{
+  SulfuricVoiceEngine engine(256);
+  engine.setCurrentPlaybackSampleRate(48000.0);
+  engine.setPolyphony(2);
+
+  for (auto note = 60; note < 63; ++note)
+    engine.noteOn(1, note, 0.8f);
+
+  CHECK(engine.getNumActiveVoices() == 2);
+  CHECK(engine.getVoiceForNote(1, 60) == -1);
+
+  engine.setPolyphony(256);
+  for (auto channel = 1; channel <= 16; ++channel)
+    for (auto note = 0; note < 16; ++note)
+      engine.noteOn(channel, 30 + note, 0.1f);
+
+  CHECK(engine.getNumActiveVoices() == 256);
+}
+
+TEST_CASE("Voice engine sheds its quietest held voices first", "[engine][governor]")
+{
+  SulfuricVoiceEngine engine(8);
+  engine.setCurrentPlaybackSampleRate(48000.0);
+
+  engine.noteOn(1, 60, 0.9f);
+  engine.noteOn(1, 62, 0.2f);
+  engine.noteOn(1, 64, 0.6f);
+  engine.noteOn(1, 65, 0.4f);
+
+  // Past the attack, so the gains are the velocities
+  juce::AudioBuffer<float> buffer(1, 2048);
+  juce::MidiBuffer midi;
+  engine.renderNextBlock(buffer, midi, 0, buffer.getNumSamples());
+
+  CHECK(engine.releaseQuietestVoices(2) == 2);
+  CHECK(engine.getVoiceForNote(1, 62) == -1);
+  CHECK(engine.getVoiceForNote(1, 65) == -1);
+  CHECK(engine.getVoiceForNote(1, 60) >= 0);
+  CHECK(engine.getVoiceForNote(1, 64) >= 0);
+
+  // Released voices keep their tails
+  CHECK(engine.getNumActiveVoices() == 4);
+  CHECK(engine.releaseQuietestVoices(2) == 0);
+}
+
+TEST_CASE("Voice engine sheds the right voices out of many in one pass", "[engine][governor]")
+{
+  SulfuricVoiceEngine engine(64);
+  engine.setCurrentPlaybackSampleRate(48000.0);
+
+  // Each note louder than the one before, on keys scattered over the range
+  for (auto note = 0; note < 64; ++note)
+    engine.noteOn(1, 30 + (note * 17) % 64, 0.1f + 0.014f * (float)note);
+
+  juce::AudioBuffer<float> buffer(1, 2048);
+  juce::MidiBuffer midi;
+  engine.renderNextBlock(buffer, midi, 0, buffer.getNumSamples());
+
+  CHECK(engine.releaseQuietestVoices(16) == 48);
+
+  for (auto note = 0; note < 64; ++note)
+  {
+    INFO("note " << note);
+    CHECK((engine.getVoiceForNote(1, 30 + (note * 17) % 64) >= 0) == (note >= 48));
+  }
+}
+
+TEST_CASE("Voice engine holds sustained notes until the pedal comes up", "[engine]")
+{
+  SulfuricVoiceEngine engine(8);
+  engine.setCurrentPlaybackSampleRate(48000.0);
+
+  engine.handleSustainPedal(1, true);
+  engine.noteOn(1, 60, 0.8f);
+  engine.noteOff(1, 60, true);
+  CHECK(engine.getVoiceForNote(1, 60) >= 0);
+
+  // Other channels are not sustained
+  engine.noteOn(2, 60, 0.8f);
+  engine.noteOff(2, 60, true);
+  CHECK(engine.getVoiceForNote(2, 60) == -1);
+
+  engine.handleSustainPedal(1, false);
+  CHECK(engine.getVoiceForNote(1, 60) == -1);
+  CHECK(engine.getNumActiveVoices() == 2);
+
+  // Finished voices go back to the pool
+  renderUntilIdle(engine);
+  CHECK(engine.getNumActiveVoices() == 0);
+
+  for (auto note = 60; note < 68; ++note)
+    engine.noteOn(1, note, 0.8f);
+
+  for (auto note = 60; note < 68; ++note)
+    CHECK(engine.getVoiceForNote(1, note) >= 0);
+}
+
+TEST_CASE("All notes off on one channel leaves the other channels' pedals down", "[engine]")
+{
+  SulfuricVoiceEngine engine(8);
+  engine.setCurrentPlaybackSampleRate(48000.0);
+
+  engine.handleSustainPedal(1, true);
+  engine.handleSustainPedal(2, true);
+  engine.allNotesOff(1, true);
+
+  engine.noteOn(1, 60, 0.8f);
+  engine.noteOff(1, 60, true);
+  CHECK(engine.getVoiceForNote(1, 60) == -1);
+
+  engine.noteOn(2, 60, 0.8f);
+  engine.noteOff(2, 60, true);
+  CHECK(engine.getVoiceForNote(2, 60) >= 0);
+
+  // Channel 0 is every channel, pedals included
+  engine.allNotesOff(0, true);
+  engine.noteOn(2, 62, 0.8f);
+  engine.noteOff(2, 62, true);
+  CHECK(engine.getVoiceForNote(2, 62) == -1);
+}
+
+TEST_CASE("Voice engine renders the same signal into every channel in either precision", "[engine]")
+{
+  auto numChannels = GENERATE(1, 2, 3);
+
+  SulfuricVoiceEngine floatEngine(8), doubleEngine(8);
+  juce::AudioBuffer<float> floatBuffer(numChannels, 1000);
+  juce::AudioBuffer<double> doubleBuffer(numChannels, 1000);
+  floatBuffer.clear();
+  doubleBuffer.clear();
+
+  juce::MidiBuffer midi;
+  midi.addEvent(juce::MidiMessage::noteOn(1, 60, 0.8f), 0);
+  midi.addEvent(juce::MidiMessage::noteOn(1, 67, 0.8f), 100);
+  midi.addEvent(juce::MidiMessage::noteOff(1, 60), 700);
+
+  for (auto* engine : { &floatEngine, &doubleEngine })
+    engine->setCurrentPlaybackSampleRate(48000.0);
+
+  CHECK(floatEngine.renderNextBlock(floatBuffer, midi, 0, 1000));
+  CHECK(doubleEngine.renderNextBlock(doubleBuffer, midi, 0, 1000));
+
+  for (auto channel = 0; channel < numChannels; ++channel)
+    for (auto i = 0; i < 1000; ++i)
+    {
+      REQUIRE(floatBuffer.getSample(channel, i) == floatBuffer.getSample(0, i));
+      REQUIRE(doubleBuffer.getSample(channel, i) == (double)floatBuffer.getSample(0, i));
+    }
+}
+
+
+TEST_CASE("Parallel voice rendering matches rendering on one thread", "[engine][workers]")
+{
+  constexpr int numVoices = 100;
+  constexpr int blockSize = 700;
+
+  // A spread unison renders each job in stereo
+  auto unisonVoices = GENERATE(1, 5);
+
+  SulfuricWorkerPool noWorkers(0), threeWorkers(3);
+  SulfuricVoiceEngine serial(256), callerOnly(256), parallel(256);
+
+  callerOnly.setWorkerPool(&noWorkers);
+  parallel.setWorkerPool(&threeWorkers);
+
+  for (auto* engine : { &serial, &callerOnly, &parallel })
+  {
+    engine->setCurrentPlaybackSampleRate(48000.0);
+    engine->setParallelThreshold(1);
+    engine->setEnvelope({ 0.005f, 0.05f, 0.6f, 0.02f });
+    engine->setUnison({ unisonVoices, 30.0f, 1.0f });
+  }
+
+  // Notes ending part way through the block, so voices retire while the jobs are split up
+  juce::MidiBuffer midi;
+  for (auto voice = 0; voice < numVoices; ++voice)
+  {
+    midi.addEvent(juce::MidiMessage::noteOn(1 + voice % 16, 30 + voice % 80, 0.2f + 0.006f * voice), voice);
+    midi.addEvent(juce::MidiMessage::noteOff(1 + voice % 16, 30 + voice % 80), blockSize + voice * 7);
+  }
+
+  juce::AudioBuffer<float> serialBuffer(2, blockSize), callerOnlyBuffer(2, blockSize), parallelBuffer(2, blockSize);
+
+  for (auto block = 0; block < 6; ++block)
+  {
+    juce::MidiBuffer blockMidi;
+    blockMidi.addEvents(midi, block * blockSize, blockSize, -block * blockSize);
+
+    for (auto* buffer : { &serialBuffer, &callerOnlyBuffer, &parallelBuffer })
+      buffer->clear();
+
+    serial.renderNextBlock(serialBuffer, blockMidi, 0, blockSize);
+    callerOnly.renderNextBlock(callerOnlyBuffer, blockMidi, 0, blockSize);
+    parallel.renderNextBlock(parallelBuffer, blockMidi, 0, blockSize);
+
+    REQUIRE(parallel.getNumActiveVoices() == serial.getNumActiveVoices());
+
+    for (auto channel = 0; channel < 2; ++channel)
+      for (auto i = 0; i < blockSize; ++i)
+      {
+        // The same jobs summed in the same order, however many threads there are
+        REQUIRE(parallelBuffer.getSample(channel, i) == callerOnlyBuffer.getSample(channel, i));
+        REQUIRE(parallelBuffer.getSample(channel, i) == Approx(serialBuffer.getSample(channel, i)).margin(1e-4));
+      }
+  }
+
+  renderUntilIdle(parallel);
+  CHECK(parallel.getNumActiveVoices() == 0);
+}
+
+
+TEST_CASE("Note ons are sample-accurate, other events land on the control-rate grid", "[engine]")
+{
+  constexpr int blockSize = 256;
+
+  auto render = [](int controlInterval, const juce::MidiBuffer& midi)
+  {
+    SulfuricVoiceEngine engine(8);
+    engine.setCurrentPlaybackSampleRate(48000.0);
+    engine.setControlInterval(controlInterval);
+
+    juce::AudioBuffer<float> buffer(1, blockSize);
+    buffer.clear();
+    engine.renderNextBlock(buffer, midi, 0, blockSize);
+    return std::vector<float>(buffer.getReadPointer(0), buffer.getReadPointer(0) + blockSize);
+  };
+
+  juce::MidiBuffer late, onGrid;
+  for (auto* midi : { &late, &onGrid })
+    midi->addEvent(juce::MidiMessage::noteOn(1, 60, 0.8f), 45);
+
+  late.addEvent(juce::MidiMessage::noteOff(1, 60), 150);
+  onGrid.addEvent(juce::MidiMessage::noteOff(1, 60), 128);
+
+  auto quantised = render(32, late);
+
+  // The note on stays where it was put
+  CHECK(quantised[44] == 0.0f);
+  CHECK(quantised[46] != 0.0f);
+
+  // The note off moves back to sample 128
+  CHECK(quantised == render(1, onGrid));
+  CHECK(quantised != render(1, late));
+
+  // Controllers the engine has no use for don't split the block
+  juce::MidiBuffer dense = late;
+  for (auto position = 0; position < blockSize; ++position)
+    dense.addEvent(juce::MidiMessage::controllerEvent(1, 1, position % 128), position);
+
+  CHECK(render(32, dense) == quantised);
+}
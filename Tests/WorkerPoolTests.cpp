@@ -0,0 +1,85 @@
+#include <WorkerPool.h>
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Worker pool runs every job exactly once per run", "[workers]")
+{
+  auto numWorkers = GENERATE(0, 1, 3, 8);
+  SulfuricWorkerPool pool(numWorkers);
+
+  std::array<std::atomic<int>, 64> counts{};
+  std::atomic<int> badThreads{ 0 };
+
+  for (auto run = 0; run < 2000; ++run)
+  {
+    auto numJobs = 1 + run % (int)counts.size();
+
+    // Catch assertions aren't thread safe, so only count here
+    auto job = [&](int index, int thread)
+    {
+      if (thread < 0 || thread >= pool.getNumThreads())
+        badThreads.fetch_add(1, std::memory_order_relaxed);
+      counts[(size_t)index].fetch_add(1, std::memory_order_relaxed);
+    };
+    pool.run(numJobs, job);
+
+    // Everything has finished by the time run returns
+    for (auto index = 0; index < numJobs; ++index)
+      REQUIRE(counts[(size_t)index].exchange(0) == 1);
+
+    for (auto index = numJobs; index < (int)counts.size(); ++index)
+      REQUIRE(counts[(size_t)index].load() == 0);
+  }
+
+  CHECK(badThreads.load() == 0);
+}
+
+TEST_CASE("Worker pool runs from several threads at once", "[workers]")
+{
+  SulfuricWorkerPool pool(3);
+  std::atomic<int> failures{ 0 };
+
+  // Like plugin instances on a host's audio threads, all sharing one pool
+  std::vector<std::thread> callers;
+  for (auto caller = 0; caller < 4; ++caller)
+    callers.emplace_back([&]
+    {
+      std::array<std::atomic<int>, 16> counts{};
+
+      for (auto run = 0; run < 1000; ++run)
+      {
+        auto job = [&](int index, int thread)
+        {
+          if (thread < 0 || thread >= pool.getNumThreads())
+            failures.fetch_add(1, std::memory_order_relaxed);
+          counts[(size_t)index].fetch_add(1, std::memory_order_relaxed);
+        };
+        pool.run((int)counts.size(), job);
+
+        for (auto& count : counts)
+          if (count.exchange(0) != 1)
+            failures.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+
+  for (auto& caller : callers)
+    caller.join();
+
+  CHECK(failures.load() == 0);
+}
+
+TEST_CASE("Worker pool is shared while anyone holds it", "[workers]")
+{
+  auto first = SulfuricWorkerPool::getShared(2);
+  auto second = SulfuricWorkerPool::getShared(5);
+  CHECK(first == second);
+  CHECK(second->getNumWorkers() == 2);
+
+  first.reset();
+  second.reset();
+  CHECK(SulfuricWorkerPool::getShared(1)->getNumWorkers() == 1);
+}